@@ -0,0 +1,171 @@
+/******************************************************************************
+  Simulated annealing with Metropolis acceptance of every move.
+
+  Every step draws a shift of a random job to one of its candidate agents
+  (jd->by_ratio) or a swap of two random jobs, with probability 1/2 each,
+  and makes it if its change d of the penalized value satisfies
+
+    d <= 0   or   random < exp(-d / T).
+
+  The temperature follows the CPU time, not the number of moves, so that a
+  run spans exactly the time limit whatever the speed of the moves. With
+  f in [0, 1] the fraction of the time used so far:
+
+    ANNEAL_GEOMETRIC	T = t0 (t1 / t0)^f
+    ANNEAL_LOG		T = t0 / (1 + (t0 / t1 - 1) log_S(1 + f (S - 1))),
+			logarithmic in f S "iterations", S = ANNEAL_LOG_SCALE
+    ANNEAL_REHEAT	geometric, but when no new best has been found for
+			the fraction ANNEAL_STALL of the time, T jumps back to
+			twice the temperature of the last new best (at most
+			t0) and cools geometrically to t1 in the time left
+
+  anneal_calibrate() sets t0 from the average worsening d of ANNEAL_SAMPLES
+  random moves, so that it is accepted with probability ANNEAL_P0 at the
+  start, and t1 = t0 ANNEAL_END. If a Penalty is given, the weights are
+  adapted (penalty_update()) every n moves. With "report" set, every new
+  best prints its line with deadline_best().
+
+  A draw that changes nothing, a shift to the agent of the job or a swap
+  of two jobs at the same agent, is drawn again (up to ANNEAL_REDRAW
+  times), so that it does not pass for an accepted move; one left over on
+  a degenerate instance is neither made nor counted.
+
+  Include this file after eval.c, penalty.c, rng.c and deadline.c.
+******************************************************************************/
+
+#define ANNEAL_GEOMETRIC	1
+#define ANNEAL_LOG		2
+#define ANNEAL_REHEAT		3
+
+#define ANNEAL_SAMPLES		1000	/* moves sampled by anneal_calibrate() */
+#define ANNEAL_P0		0.5	/* acceptance of an average worsening, at first */
+#define ANNEAL_END		0.001	/* t1 / t0 */
+#define ANNEAL_LOG_SCALE	1e6	/* the "iterations" of the logarithmic schedule */
+#define ANNEAL_STALL		0.05	/* time fraction without a new best to reheat */
+#define ANNEAL_BATCH		256	/* moves between two updates of T */
+#define ANNEAL_REDRAW		16	/* draws for a move that changes something */
+
+typedef struct {
+  int		schedule;	/* ANNEAL_GEOMETRIC, ANNEAL_LOG or ANNEAL_REHEAT */
+  double	t0;		/* the initial temperature */
+  double	t1;		/* the final temperature */
+  double	t;		/* the current temperature */
+  double	t_best;		/* the temperature of the last new best */
+  double	f_best;		/* the time fraction of the last new best */
+  double	f_re;		/* the time fraction of the last reheat */
+  double	t_re;		/* the temperature after the last reheat */
+  long		moves;		/* moves tried */
+  long		accepted;	/* moves made */
+  int		reheats;	/* reheats so far */
+  bool		report;		/* print every new best with deadline_best() */
+} Anneal;
+
+void anneal_init(Anneal *an, int schedule) {
+  an->schedule = schedule;
+  an->t0 = an->t1 = an->t = an->t_best = an->t_re = 1.0;
+  an->f_best = an->f_re = 0.0;
+  an->moves = an->accepted = 0;
+  an->reheats = 0;
+  an->report = false;
+}
+
+/***** true if the move leaves the solution as it is ************************/
+static inline bool anneal_noop(const Evaldata *ev, int j1, int j2, int i) {
+  return (j2 < 0) ? ev->sol[j1] == i : ev->sol[j1] == ev->sol[j2];
+}
+
+/***** draw a move; its change of the penalized value ************************/
+static inline int anneal_draw(const Evaldata *ev, Rng *rng, int *j1, int *j2, int *i) {
+  const Jobdata *jd = ev->jd;
+
+  for (int t=0; t<ANNEAL_REDRAW; t++) {
+    *j1 = rng_int(rng, jd->n);
+    if (rng_next(rng) & 1) {
+      *j2 = -1;
+      *i = jd->by_ratio[*j1 * jd->k + rng_int(rng, jd->k)];
+    } else {
+      *j2 = rng_int(rng, jd->n);
+      *i = ev->sol[*j2];	/* the agent j1 goes to */
+    }
+    if (!anneal_noop(ev, *j1, *j2, *i)) break;
+  }
+  if (*j2 < 0) return eval_move_delta(ev, *j1, *i).value;
+  return eval_swap_delta(ev, *j1, *j2).value;
+}
+
+/***** t0 and t1 from the worsening moves around ev **************************/
+void anneal_calibrate(Anneal *an, const Evaldata *ev, Rng *rng) {
+  double sum = 0.0;
+  int worse = 0, d, j1, j2, i;
+
+  for (int k=0; k<ANNEAL_SAMPLES; k++) {
+    d = anneal_draw(ev, rng, &j1, &j2, &i);
+    if (d > 0) {
+      sum += d;
+      worse++;
+    }
+  }
+  sum = (worse > 0) ? sum / worse : 1.0;
+  an->t0 = an->t = an->t_best = an->t_re = -sum / log(ANNEAL_P0);
+  an->t1 = an->t0 * ANNEAL_END;
+}
+
+/***** the temperature at time fraction f ************************************/
+static void anneal_cool(Anneal *an, double f) {
+  f = min(1.0, max(0.0, f));
+  switch (an->schedule) {
+  case ANNEAL_LOG:
+    an->t = an->t0 / (1.0 + (an->t0 / an->t1 - 1.0)
+        * log(1.0 + f * (ANNEAL_LOG_SCALE - 1.0)) / log(ANNEAL_LOG_SCALE));
+    break;
+  case ANNEAL_REHEAT:
+    if (f - max(an->f_best, an->f_re) > ANNEAL_STALL && f < 1.0) {
+      an->f_re = f;
+      an->t_re = min(an->t0, 2.0 * an->t_best);
+      an->reheats++;
+    }
+    an->t = an->t_re * pow(an->t1 / an->t_re, (f - an->f_re) / (1.0 - an->f_re));
+    break;
+  default:
+    an->t = an->t0 * pow(an->t1 / an->t0, f);
+    break;
+  }
+}
+
+/***** anneal ev until dl is over or best_cost <= bound **********************/
+/***** best and best_cost are the best feasible solution; returns best_cost **/
+int anneal_run(Anneal *an, Evaldata *ev, Rng *rng, Penalty *pen, Deadline *dl,
+    int *best, int best_cost, int bound) {
+  const Jobdata *jd = ev->jd;
+  double start = deadline_elapsed(dl);
+  double span = max(dl->limit - start, 1e-9);
+  double f = 0.0;
+  int d, j1, j2, i;
+
+  while (!deadline_over(dl) && best_cost > bound) {
+    for (int k=0; k<ANNEAL_BATCH; k++) {
+      if (pen != NULL && an->moves % jd->n == 0) penalty_update(pen, ev, jd->m);
+      d = anneal_draw(ev, rng, &j1, &j2, &i);
+      if (anneal_noop(ev, j1, j2, i)) continue;
+      an->moves++;
+      if (d > 0 && rng_double(rng) >= exp(-d / an->t)) continue;
+      if (j2 < 0) {
+        eval_move(ev, j1, i);
+      } else {
+        eval_swap(ev, j1, j2);
+      }
+      an->accepted++;
+
+      if (ev->excess == 0 && ev->cost < best_cost) {
+        best_cost = ev->cost;
+        for (int j=0; j<jd->n; j++) best[j] = ev->sol[j];
+        an->t_best = an->t;
+        an->f_best = f;
+        if (an->report) deadline_best(dl, best_cost);
+      }
+    }
+    f = (deadline_elapsed(dl) - start) / span;
+    anneal_cool(an, f);
+  }
+  return best_cost;
+}
@@ -0,0 +1,114 @@
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+files = ['c05100', 'c05200', 'c10100', 'c10200', 'c10400', 'c20100', 'c20200', 'c20400', 'c40400',
+         'd05100', 'd05200', 'd10100', 'd10200', 'd10400', 'd20100', 'd20200', 'd20400', 'd40400',
+         'e05100', 'e05200', 'e10100', 'e10200', 'e10400', 'e20100', 'e20200', 'e20400', 'e40400']
+
+# Best known (mostly optimal) costs of the instances in data/.
+best_known = {
+    'c05100': 1931, 'c05200': 3456, 'c10100': 1402, 'c10200': 2806, 'c10400': 5597,
+    'c20100': 1243, 'c20200': 2391, 'c20400': 4782, 'c40400': 4244,
+    'd05100': 6353, 'd05200': 12742, 'd10100': 6347, 'd10200': 12430, 'd10400': 24961,
+    'd20100': 6185, 'd20200': 12235, 'd20400': 24563, 'd40400': 24350,
+    'e05100': 12681, 'e05200': 24930, 'e10100': 11577, 'e10200': 23307, 'e10400': 45746,
+    'e20100': 8436, 'e20200': 22379, 'e20400': 44877, 'e40400': 44561,
+}
+
+re_cost = re.compile(r'^recomputed cost = (-?\d+)', re.M)
+re_search = re.compile(r'^time for the search:\s+([\d.]+)', re.M)
+# every solver prints this line whenever its best feasible solution improves
+re_best = re.compile(r'^BEST Cost: (-?\d+) Time: ([\d.]+)', re.M)
+
+
+def run(solver, fn, seed, args):
+    """Run the solver once and parse what recompute_cost() printed."""
+    cmd = [solver, 'timelim', str(args.timelim), 'givesol', '0', 'seed', str(seed)] + args.param
+    start = time.time()
+    with open(os.path.join(args.data, fn)) as f:
+        out = subprocess.run(cmd, stdin=f, stdout=subprocess.PIPE,
+                             stderr=subprocess.DEVNULL, universal_newlines=True).stdout
+    wall = time.time() - start
+
+    cost = re_cost.search(out)
+    search = re_search.search(out)
+    result = {
+        'seed': seed,
+        'cost': int(cost.group(1)) if cost else None,
+        'feasible': cost is not None and 'INFEASIBLE!!' not in out,
+        'time': float(search.group(1)) if search else None,
+        'wall': round(wall, 3),
+        'time_to_best': time_to_best(out),
+    }
+    return result
+
+
+def time_to_best(out):
+    """The time of the first "BEST" line with the final best cost, or None."""
+    best = [(int(c), float(t)) for c, t in re_best.findall(out)]
+    if not best:
+        return None
+    last = min(c for c, t in best)
+    return next(t for c, t in best if c == last)
+
+
+def summarize(fn, runs):
+    costs = [r['cost'] for r in runs if r['feasible']]
+    summary = {'instance': fn, 'runs': runs, 'feasible': len(costs)}
+    if costs:
+        summary['best'] = min(costs)
+        summary['worst'] = max(costs)
+        summary['mean'] = sum(costs) / len(costs)
+        if fn in best_known:
+            summary['best_known'] = best_known[fn]
+            summary['gap_best'] = 100.0 * (summary['best'] - best_known[fn]) / best_known[fn]
+            summary['gap_mean'] = 100.0 * (summary['mean'] - best_known[fn]) / best_known[fn]
+        ttb = [r['time_to_best'] for r in runs if r['feasible'] and r['time_to_best'] is not None]
+        if ttb:
+            summary['time_to_best'] = sum(ttb) / len(ttb)
+    return summary
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Run a solver over the instances in data/.')
+    parser.add_argument('solver', nargs='?', default='./gap', help='the solver binary (./gap)')
+    parser.add_argument('--seeds', type=int, default=3, help='runs per instance, with seeds 1..N')
+    parser.add_argument('--timelim', type=int, default=10,
+                        help='timelim of every run in CPU seconds of the whole process')
+    parser.add_argument('--instances', nargs='*', default=files, help='instance names')
+    parser.add_argument('--data', default='data', help='directory of the instances')
+    parser.add_argument('--param', nargs='*', default=[],
+                        help='further "name value" parameters of the solver')
+    args = parser.parse_args()
+
+    results = []
+    for fn in args.instances:
+        runs = [run(args.solver, fn, seed, args) for seed in range(1, args.seeds + 1)]
+        summary = summarize(fn, runs)
+        results.append(summary)
+        print(fn, summary.get('best'), summary.get('mean'), summary.get('gap_best'), file=sys.stderr)
+
+    gaps = [s['gap_mean'] for s in results if 'gap_mean' in s]
+    report = {
+        'solver': args.solver,
+        'timelim': args.timelim,
+        # the threads of a parallel solver share timelim, so "time" is the
+        # CPU time of the whole process and "wall" the elapsed time
+        'clock': 'process CPU seconds, shared by the threads of a parallel solver',
+        'seeds': args.seeds,
+        'param': args.param,
+        'instances': results,
+        'mean_gap': sum(gaps) / len(gaps) if gaps else None,
+        'infeasible_runs': sum(len(s['runs']) - s['feasible'] for s in results),
+    }
+    json.dump(report, sys.stdout, indent=1)
+    print()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,138 @@
+/******************************************************************************
+  Cheap checking of the time limit.
+
+  cpu_time() costs a getrusage() system call. deadline_over() is meant to
+  be called in every iteration of a search loop instead: it only counts
+  down, and reads a cheap clock (CLOCK_MONOTONIC_COARSE, served without a
+  system call) after "interval" calls, where the interval is recalibrated
+  at every read so that reads happen about every DEADLINE_TICK seconds.
+
+  The CPU time used by a single thread cannot grow faster than the clock,
+  so cpu + (clock - clock at cpu) is an upper bound of the CPU time used.
+  Only when this bound reaches the time limit, or every DEADLINE_CONFIRM
+  seconds, is the real CPU time read with cpu_time(). The search therefore
+  never stops before "timelim" CPU seconds have been consumed, and stops
+  at most about DEADLINE_TICK seconds (plus one iteration) after that.
+
+  A search thread running next to others uses deadline_init_thread(), which
+  measures the CPU time of that thread only, so that each thread may use
+  "timelim" CPU seconds.
+
+  deadline_used() reads the CPU time used so far directly, for the rare
+  places that need it exactly, e.g. to cap a lower bound computation.
+  deadline_best() prints the line "BEST Cost: c Time: t" of a new best
+  feasible solution, from which bench.py takes the time to the best.
+
+  Include this file after cpu_time.c.
+******************************************************************************/
+
+#include <time.h>
+
+#ifdef CLOCK_MONOTONIC_COARSE
+#define DEADLINE_CLOCK	CLOCK_MONOTONIC_COARSE
+#else
+#define DEADLINE_CLOCK	CLOCK_MONOTONIC
+#endif
+
+#define DEADLINE_TICK		0.005	/* seconds between two clock reads */
+#define DEADLINE_CONFIRM	1.0	/* seconds between two cpu_time() */
+
+typedef struct {
+  double	start;		/* the CPU time at the start of the search */
+  double	limit;		/* the time limit in CPU seconds */
+  double	cpu;		/* the CPU time at the last confirmation */
+  double	wall;		/* the clock at the last confirmation */
+  double	stamp;		/* the clock at the last read */
+  long		interval;	/* calls of deadline_over() between two reads */
+  long		countdown;	/* calls left until the next read */
+  bool		over;		/* the time limit has been reached */
+  bool		thread;		/* count the CPU time of this thread only */
+} Deadline;
+
+static double deadline_clock(void) {
+  struct timespec ts;
+  clock_gettime(DEADLINE_CLOCK, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/***** the CPU time of the process, or of the calling thread ****************/
+static double deadline_cpu(const Deadline *dl) {
+  struct timespec ts;
+
+  if (!dl->thread) return cpu_time();
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void deadline_start(Deadline *dl, double limit) {
+  dl->limit = limit;
+  dl->cpu = deadline_cpu(dl);
+  dl->wall = dl->stamp = deadline_clock();
+  dl->interval = dl->countdown = 1;
+  dl->over = (dl->cpu - dl->start >= dl->limit);
+}
+
+/***** the search started at cpu_time() == start and may use limit seconds ***/
+void deadline_init(Deadline *dl, double start, double limit) {
+  dl->thread = false;
+  dl->start = start;
+  deadline_start(dl, limit);
+}
+
+/***** the calling thread starts now and may use limit CPU seconds ***********/
+void deadline_init_thread(Deadline *dl, double limit) {
+  dl->thread = true;
+  dl->start = deadline_cpu(dl);
+  deadline_start(dl, limit);
+}
+
+/***** read the clock, recalibrate, and confirm with cpu_time() if needed ****/
+bool deadline_check(Deadline *dl) {
+  double now = deadline_clock();
+  double dt = now - dl->stamp;
+  long next;
+
+  /* the coarse clock did not move, or moved too little: read less often */
+  if (dt < DEADLINE_TICK / 2) {
+    next = dl->interval * 2;
+  } else {
+    next = (long) (dl->interval * DEADLINE_TICK / dt);
+    if (next < dl->interval / 2) next = dl->interval / 2;
+    if (next > dl->interval * 2) next = dl->interval * 2;
+  }
+  dl->interval = (next > 0) ? next : 1;
+  dl->countdown = dl->interval;
+  dl->stamp = now;
+
+  if (dl->cpu + (now - dl->wall) - dl->start >= dl->limit
+      || now - dl->wall >= DEADLINE_CONFIRM) {
+    dl->cpu = deadline_cpu(dl);
+    dl->wall = now;
+    dl->over = (dl->cpu - dl->start >= dl->limit);
+  }
+  return dl->over;
+}
+
+/***** true once the time limit has been reached *****************************/
+static inline bool deadline_over(Deadline *dl) {
+  if (--dl->countdown > 0) return dl->over;
+  return deadline_check(dl);
+}
+
+/***** an estimate of the CPU seconds used so far, without reading a clock ***/
+static inline double deadline_elapsed(const Deadline *dl) {
+  return dl->cpu + (dl->stamp - dl->wall) - dl->start;
+}
+
+/***** the CPU seconds used so far, read from the clock **********************/
+/***** unlike deadline_check(), it leaves the countdown as it is *************/
+double deadline_used(const Deadline *dl) {
+  return deadline_cpu(dl) - dl->start;
+}
+
+/***** report a new best feasible cost and the CPU seconds used so far *******/
+/***** deadline_check() would take the calls in a burst of new bests for *****/
+/***** a fast loop and stretch the interval, so read the clock instead *******/
+void deadline_best(const Deadline *dl, int cost) {
+  printf("BEST Cost: %d Time: %f\n", cost, deadline_used(dl));
+}
@@ -0,0 +1,97 @@
+/******************************************************************************
+  Ejection chains.
+
+  A chain shifts job j_0 to agent i_1. If i_1 is now overloaded, a job j_1
+  is ejected from i_1 to agent i_2, and so on, up to "depth" shifts:
+
+    j_0: i_0 -> i_1,  j_1: i_1 -> i_2,  ...
+
+  so that a single overloaded agent can be relieved even if no single shift
+  or swap improves the penalized value. The chain is built with eval_move()
+  on the Evaldata itself and undone with eval_move() if it does not improve,
+  so every step is O(1).
+
+  To keep the search small, job j is only tried on its "width" cheapest
+  other agents (from the candidate list jd->by_cost), and only jobs
+  whose removal alone ends the overload of i_k are ejected from i_k, at most
+  "width" of them per step. They are found in the job list of i_k, so the
+  Evaldata must have a Joblist attached (eval_jobs()).
+
+  Include this file after eval.c and rng.c.
+******************************************************************************/
+
+typedef struct {
+  int	depth;		/* the most shifts in one chain */
+  int	width;		/* agents per job, and ejected jobs per agent */
+  char	*used;		/* used[j]: job j is in the current chain */
+  int	m;		/* number of agents */
+  int	n;		/* number of jobs */
+} Ejection;
+
+void ejection_init(Ejection *ej, int depth, int width, const Jobdata *jd) {
+  ej->depth = depth;
+  ej->width = min(width, jd->k - 1);
+  ej->m = jd->m;
+  ej->n = jd->n;
+  ej->used = (char *) malloc_e(jd->n);
+  for (int j=0; j<jd->n; j++) ej->used[j] = 0;
+}
+
+void ejection_free(Ejection *ej) {
+  free((void *) ej->used);
+}
+
+/***** shift job j as step d of a chain; true if the chain improves value ****/
+static bool ejection_step(Ejection *ej, Evaldata *ev, Rng *rng, int d, int j,
+    int value) {
+  const Jobdata *jd = ev->jd;
+  const Joblist *jl = ev->jobs;
+  int from = ev->sol[j];
+  int i, over, tried, start, j2;
+
+  ej->used[j] = 1;
+  tried = 0;
+  for (int k=0; k<jd->k && tried<ej->width; k++) {
+    i = jd->by_cost[j * jd->k + k];
+    if (i == from) continue;
+    tried++;
+
+    eval_move(ev, j, i);
+    if (eval_value(ev) < value) {
+      ej->used[j] = 0;
+      return true;
+    }
+
+    /* eject a job that alone ends the overload of agent i */
+    over = -ev->rest_b[i];
+    if (d+1 < ej->depth && over > 0) {
+      /* a failed chain restores the list of i, but maybe in another order */
+      start = rng_int(rng, jl->count[i]);
+      for (int e=0, found=0; e<jl->count[i] && found<ej->width; e++) {
+        j2 = joblist_job(jl, i, (start + e) % jl->count[i]);
+        if (ej->used[j2] || jobdata_a(jd, j2, i) < over) continue;
+        found++;
+        if (ejection_step(ej, ev, rng, d+1, j2, value)) {
+          ej->used[j] = 0;
+          return true;
+        }
+      }
+    }
+    eval_move(ev, j, from);
+  }
+  ej->used[j] = 0;
+  return false;
+}
+
+/***** apply the first improving chain; false if there is none ***************/
+bool ejection_chain(Ejection *ej, Evaldata *ev, Rng *rng) {
+  int value = eval_value(ev);
+  int start;
+
+  if (ej->depth == 0) return false;
+  start = rng_int(rng, ej->n);
+  for (int k=0; k<ej->n; k++) {
+    if (ejection_step(ej, ev, rng, 0, (start + k) % ej->n, value)) return true;
+  }
+  return false;
+}
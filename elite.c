@@ -0,0 +1,116 @@
+/******************************************************************************
+  A pool of good and diverse feasible solutions, shared by search threads.
+
+  The pool keeps up to "capacity" solutions sorted by cost, the best first,
+  together with the number of the thread (the "owner") that found each of
+  them. The diversity is measured by the Hamming distance, the number of
+  jobs assigned to different agents. A solution enters
+
+    - if it is better than the best member, or
+    - if it is better than the worst member (or the pool is not full),
+      and at least "mindist" jobs away from every member,
+
+  and then replaces, if the pool is full, the member most similar to it
+  among those worse than it. Replacing the worst member instead would soon
+  fill the pool with the neighbours of one local optimum. A thread restarts
+  from a random member with elite_draw(), so that the threads continue from
+  each other's solutions; a mindist of 1 only keeps out copies.
+
+  The pool is protected by a mutex. It is only touched at the end and at
+  the start of a search, which are rare next to the moves in between, so
+  the lock is cheap; incumbent.c stays the lock-free way to publish and
+  read the single best solution.
+
+  Include this file after rng.c; link with -pthread.
+******************************************************************************/
+
+#include <pthread.h>
+
+typedef struct {
+  int		capacity;	/* the most solutions in the pool */
+  int		size;		/* solutions in the pool */
+  int		n;		/* number of jobs */
+  int		mindist;	/* the least distance of a new member to the others */
+  int		*cost;		/* cost[k]: the cost of the k-th best solution */
+  int		*owner;		/* owner[k]: the thread that found it */
+  int		*sol;		/* sol[k*n + j]: the k-th best solution */
+  pthread_mutex_t	lock;
+} Elite;
+
+void elite_init(Elite *el, int capacity, int n, int mindist) {
+  el->capacity = capacity;
+  el->size = 0;
+  el->n = n;
+  el->mindist = mindist;
+  el->cost = (int *) malloc_e(capacity * sizeof(int));
+  el->owner = (int *) malloc_e(capacity * sizeof(int));
+  el->sol = (int *) malloc_e((size_t) capacity * n * sizeof(int));
+  pthread_mutex_init(&el->lock, NULL);
+}
+
+void elite_free(Elite *el) {
+  pthread_mutex_destroy(&el->lock);
+  free((void *) el->cost);
+  free((void *) el->owner);
+  free((void *) el->sol);
+}
+
+/***** the number of jobs assigned to different agents ***********************/
+static inline int elite_distance(const int *s1, const int *s2, int n) {
+  int d = 0;
+
+  for (int j=0; j<n; j++) d += (s1[j] != s2[j]);
+  return d;
+}
+
+/***** put sol into the pool if it is good and new enough; true if entered ***/
+bool elite_offer(Elite *el, const int *sol, int cost, int owner) {
+  int k, d, n = el->n;
+  int out = el->size, nearest = INT_MAX;
+
+  pthread_mutex_lock(&el->lock);
+  if (el->size == el->capacity && cost >= el->cost[el->size-1]) {
+    pthread_mutex_unlock(&el->lock);
+    return false;
+  }
+  for (k=0; k<el->size; k++) {
+    d = elite_distance(el->sol + (size_t) k * n, sol, n);
+    if (d == 0 || (d < el->mindist && cost >= el->cost[0])) {
+      pthread_mutex_unlock(&el->lock);
+      return false;
+    }
+    if (el->cost[k] > cost && d < nearest) {
+      nearest = d;
+      out = k;
+    }
+  }
+
+  /* drop the member most similar to sol among the worse ones if full, */
+  /* then move the members between its place and that of sol by one */
+  if (el->size < el->capacity) out = el->size++;
+  for (k=0; k<out && el->cost[k]<=cost; k++);
+  memmove(el->sol + (size_t) (k+1) * n, el->sol + (size_t) k * n,
+      (size_t) (out - k) * n * sizeof(int));
+  memmove(el->cost + k + 1, el->cost + k, (out - k) * sizeof(int));
+  memmove(el->owner + k + 1, el->owner + k, (out - k) * sizeof(int));
+  memcpy(el->sol + (size_t) k * n, sol, n * sizeof(int));
+  el->cost[k] = cost;
+  el->owner[k] = owner;
+  pthread_mutex_unlock(&el->lock);
+  return true;
+}
+
+/***** copy a random member into sol; its cost, or INT_MAX if empty **********/
+int elite_draw(Elite *el, int *sol, int *owner, Rng *rng) {
+  int k, cost = INT_MAX;
+
+  pthread_mutex_lock(&el->lock);
+  if (el->size > 0) {
+    k = rng_int(rng, el->size);
+    memcpy(sol, el->sol + (size_t) k * el->n, el->n * sizeof(int));
+    cost = el->cost[k];
+    *owner = el->owner[k];
+  }
+  pthread_mutex_unlock(&el->lock);
+  return cost;
+}
@@ -0,0 +1,157 @@
+/******************************************************************************
+  Incremental evaluation of a (possibly infeasible) GAP solution.
+
+  An Evaldata keeps, next to the solution sol[j] and the residual capacity
+  rest_b[i] of each agent, the assignment cost, the total capacity excess
+  and the penalty, so that the penalized value
+
+    cost + penalty,   penalty = sum_i weight[i] * max(0, -rest_b[i])
+
+  is available in O(1) after every move instead of rescanning all n jobs and
+  m agents. Shifting one job or swapping the agents of two jobs is O(1).
+  Moves read c and a from the job-major Jobdata.
+
+  The weights belong to the caller and may differ per agent. Change them
+  with eval_weight(), which keeps the penalty up to date in O(1).
+
+  eval_jobs() attaches a Joblist, which the moves then keep up to date, for
+  searches that need the jobs of an agent. eval_init() detaches it.
+
+  Include this file after jobdata.c and joblist.c.
+******************************************************************************/
+
+typedef struct {
+  int	*sol;		/* the agent each job is assigned to */
+  int	*rest_b;	/* the amount of resource left at each agent */
+  int	cost;		/* sum of c[sol[j]][j] */
+  int	excess;		/* sum of the capacity excess max(0, -rest_b[i]) */
+  int	penalty;	/* sum of weight[i] * max(0, -rest_b[i]) */
+  int	*weight;	/* the penalty per unit of excess at each agent */
+  const Jobdata	*jd;	/* the instance in job-major order */
+  Joblist	*jobs;		/* the jobs of each agent, or NULL */
+} Evaldata;
+
+typedef struct {
+  int	cost;		/* the change of the cost */
+  int	excess;		/* the change of the capacity excess */
+  int	value;		/* the change of the penalized value */
+} Evaldelta;		/* the effect of a move, without making it */
+
+/***** attach sol and rest_b, and compute everything from scratch ************/
+void eval_init(Evaldata *ev, int *sol, int *rest_b, int *weight,
+    const Jobdata *jd, GAPdata *gapdata) {
+  ev->sol = sol;
+  ev->rest_b = rest_b;
+  ev->weight = weight;
+  ev->jd = jd;
+  ev->jobs = NULL;
+  ev->excess = ev->penalty = 0;
+
+  for (int i=0; i<gapdata->m; i++) rest_b[i] = gapdata->b[i];
+  ev->cost = jobdata_load(jd, sol, rest_b);
+  for (int i=0; i<gapdata->m; i++) {
+    if (rest_b[i] < 0) {
+      ev->excess -= rest_b[i];
+      ev->penalty -= weight[i] * rest_b[i];
+    }
+  }
+}
+
+/***** keep the jobs of each agent in jl from now on *************************/
+void eval_jobs(Evaldata *ev, Joblist *jl) {
+  joblist_build(jl, ev->sol);
+  ev->jobs = jl;
+}
+
+/***** the penalized value of the current solution ***************************/
+static inline int eval_value(const Evaldata *ev) {
+  return ev->cost + ev->penalty;
+}
+
+/***** set the weight of agent i to w ****************************************/
+static inline void eval_weight(Evaldata *ev, int i, int w) {
+  ev->penalty += (w - ev->weight[i]) * max(0, -ev->rest_b[i]);
+  ev->weight[i] = w;
+}
+
+/***** change the residual capacity of agent i by d **************************/
+static inline void eval_rest(Evaldata *ev, int i, int d) {
+  int before = ev->rest_b[i];
+  int after = before + d;
+  int d_excess = max(0, -after) - max(0, -before);
+
+  ev->rest_b[i] = after;
+  ev->excess += d_excess;
+  ev->penalty += ev->weight[i] * d_excess;
+}
+
+/***** reassign job j to agent i *********************************************/
+static inline void eval_move(Evaldata *ev, int j, int i) {
+  const Jobdata *jd = ev->jd;
+  int from = ev->sol[j];
+
+  if (from == i) return;
+  ev->cost += jobdata_c(jd, j, i) - jobdata_c(jd, j, from);
+  eval_rest(ev, from, jobdata_a(jd, j, from));
+  eval_rest(ev, i, -jobdata_a(jd, j, i));
+  ev->sol[j] = i;
+  if (ev->jobs) joblist_move(ev->jobs, j, from, i);
+}
+
+/***** exchange the agents of jobs j1 and j2 *********************************/
+static inline void eval_swap(Evaldata *ev, int j1, int j2) {
+  const Jobdata *jd = ev->jd;
+  int i1 = ev->sol[j1];
+  int i2 = ev->sol[j2];
+
+  if (i1 == i2) return;
+  ev->cost += jobdata_c(jd, j1, i2) + jobdata_c(jd, j2, i1)
+    - jobdata_c(jd, j1, i1) - jobdata_c(jd, j2, i2);
+  eval_rest(ev, i1, jobdata_a(jd, j1, i1) - jobdata_a(jd, j2, i1));
+  eval_rest(ev, i2, jobdata_a(jd, j2, i2) - jobdata_a(jd, j1, i2));
+  ev->sol[j1] = i2;
+  ev->sol[j2] = i1;
+  if (ev->jobs) {
+    joblist_move(ev->jobs, j1, i1, i2);
+    joblist_move(ev->jobs, j2, i2, i1);
+  }
+}
+
+/***** the effect of changing the residual capacity of agent i by d *********/
+static inline void eval_rest_delta(const Evaldata *ev, int i, int d, Evaldelta *dt) {
+  int before = ev->rest_b[i];
+  int d_excess = max(0, -(before + d)) - max(0, -before);
+
+  dt->excess += d_excess;
+  dt->value += ev->weight[i] * d_excess;
+}
+
+/***** the effect of eval_move(ev, j, i) *************************************/
+static inline Evaldelta eval_move_delta(const Evaldata *ev, int j, int i) {
+  const Jobdata *jd = ev->jd;
+  int from = ev->sol[j];
+  Evaldelta dt = {0, 0, 0};
+
+  if (from == i) return dt;
+  dt.cost = jobdata_c(jd, j, i) - jobdata_c(jd, j, from);
+  dt.value = dt.cost;
+  eval_rest_delta(ev, from, jobdata_a(jd, j, from), &dt);
+  eval_rest_delta(ev, i, -jobdata_a(jd, j, i), &dt);
+  return dt;
+}
+
+/***** the effect of eval_swap(ev, j1, j2) ***********************************/
+static inline Evaldelta eval_swap_delta(const Evaldata *ev, int j1, int j2) {
+  const Jobdata *jd = ev->jd;
+  int i1 = ev->sol[j1];
+  int i2 = ev->sol[j2];
+  Evaldelta dt = {0, 0, 0};
+
+  if (i1 == i2) return dt;
+  dt.cost = jobdata_c(jd, j1, i2) + jobdata_c(jd, j2, i1)
+    - jobdata_c(jd, j1, i1) - jobdata_c(jd, j2, i2);
+  dt.value = dt.cost;
+  eval_rest_delta(ev, i1, jobdata_a(jd, j1, i1) - jobdata_a(jd, j2, i1), &dt);
+  eval_rest_delta(ev, i2, jobdata_a(jd, j2, i2) - jobdata_a(jd, j1, i2), &dt);
+  return dt;
+}
@@ -0,0 +1,130 @@
+/******************************************************************************
+  A fast reader for instances in the text format of read_instance().
+
+  read_instance_fast() reads STDIN with read(2) in blocks of FAST_READ_BLOCK
+  bytes and converts the integers with a small scanner that only knows
+  digits, '-' and white space, instead of calling fscanf() once per value.
+  It fills GAPdata exactly as read_instance() does, but rejects integers
+  beyond INT_MAX and sizes whose m x n matrices cannot be allocated.
+
+  Since the instance is read in blocks, the reader may consume input beyond
+  the instance. Use read_instance() when a solution follows on STDIN.
+
+  Include this file after the definition of GAPdata.
+******************************************************************************/
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FAST_READ_BLOCK	(1 << 16)
+
+typedef struct {
+  char		buf[FAST_READ_BLOCK];
+  char		*p;		/* the next byte to scan */
+  char		*end;		/* the end of the valid bytes in buf */
+  long		bytes;		/* bytes read so far */
+  long		values;		/* integers converted so far */
+  double	io;		/* seconds spent in read() */
+} Fastreader;
+
+static double fast_read_clock(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/***** read the next block; returns false at the end of the input ************/
+static bool fast_read_fill(Fastreader *fr) {
+  double t = fast_read_clock();
+  ssize_t len;
+
+  do {
+    len = read(STDIN_FILENO, fr->buf, FAST_READ_BLOCK);
+  } while (len < 0 && errno == EINTR);
+  fr->io += fast_read_clock() - t;
+  if (len <= 0) return false;
+
+  fr->p = fr->buf;
+  fr->end = fr->buf + len;
+  fr->bytes += len;
+  return true;
+}
+
+/***** the next byte, or -1 at the end of the input **************************/
+static inline int fast_read_byte(Fastreader *fr) {
+  if (fr->p == fr->end && !fast_read_fill(fr)) return -1;
+  return (unsigned char) *fr->p++;
+}
+
+/***** the next integer ******************************************************/
+static int fast_read_int(Fastreader *fr) {
+  int ch, value = 0;
+  bool neg = false;
+
+  do {
+    ch = fast_read_byte(fr);
+  } while (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r');
+  if (ch == '-') {
+    neg = true;
+    ch = fast_read_byte(fr);
+  }
+  if (ch < '0' || ch > '9') {
+    fprintf(stderr, "fast_read : %s after %ld values.\n",
+        ch < 0 ? "unexpected end of input" : "unexpected character", fr->values);
+    exit(EXIT_FAILURE);
+  }
+  do {
+    if (value > (INT_MAX - (ch - '0')) / 10) {
+      fprintf(stderr, "fast_read : integer out of range after %ld values.\n", fr->values);
+      exit(EXIT_FAILURE);
+    }
+    value = value * 10 + (ch - '0');
+    ch = fast_read_byte(fr);
+  } while (ch >= '0' && ch <= '9');
+
+  fr->values++;
+  return neg ? -value : value;
+}
+
+/***** read the instance data; print the timings to STDERR if verbose ********/
+void read_instance_fast(GAPdata *gapdata, bool verbose) {
+  Fastreader *fr = (Fastreader *) malloc_e(sizeof(Fastreader));
+  double t = fast_read_clock();
+
+  fr->p = fr->end = fr->buf;
+  fr->bytes = fr->values = 0;
+  fr->io = 0.0;
+
+  gapdata->m = fast_read_int(fr);
+  gapdata->n = fast_read_int(fr);
+  if (gapdata->m <= 0 || gapdata->n <= 0 || gapdata->n > INT_MAX / gapdata->m
+      || (size_t) gapdata->m * gapdata->n > SIZE_MAX / sizeof(int)) {
+    fprintf(stderr, "fast_read : invalid size %d x %d.\n", gapdata->m, gapdata->n);
+    exit(EXIT_FAILURE);
+  }
+
+  gapdata->c    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->c[0] = (int *)  malloc_e((size_t) gapdata->m * gapdata->n * sizeof(int));
+  for (int i=1; i<gapdata->m; i++) gapdata->c[i] = gapdata->c[i-1] + gapdata->n;
+  gapdata->a    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->a[0] = (int *)  malloc_e((size_t) gapdata->m * gapdata->n * sizeof(int));
+  for (int i=1; i<gapdata->m; i++) gapdata->a[i] = gapdata->a[i-1] + gapdata->n;
+  gapdata->b    = (int *)  malloc_e(gapdata->m * sizeof(int));
+
+  for (int k=0; k<gapdata->m * gapdata->n; k++) gapdata->c[0][k] = fast_read_int(fr);
+  for (int k=0; k<gapdata->m * gapdata->n; k++) gapdata->a[0][k] = fast_read_int(fr);
+  for (int i=0; i<gapdata->m; i++) gapdata->b[i] = fast_read_int(fr);
+
+  t = fast_read_clock() - t;
+  if (verbose) {
+    fprintf(stderr, "fast read: %ld values, %ld bytes\n", fr->values, fr->bytes);
+    fprintf(stderr, "  time in read():            %9.6f seconds\n", fr->io);
+    fprintf(stderr, "  time to parse:             %9.6f seconds\n", t - fr->io);
+    fprintf(stderr, "  total:                     %9.6f seconds (%.1f MB/s)\n",
+        t, t > 0 ? fr->bytes / t / 1e6 : 0.0);
+  }
+  free((void *) fr);
+}
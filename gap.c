@@ -32,6 +32,13 @@ the definition of struct "Param" and mimic the way the default value of
 /***** default values of parameters ******************************************/
 #define	TIMELIM	300	/* the time limit for the algorithm in seconds */
 #define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
+#define	ADAPTIVE 1	/* 1: adapt the penalty weights; 0: INFEASIBLE_COST */
+#define	CHAIN	3	/* the longest ejection chain; 0: none */
+#define	CHAIN_WIDTH 3	/* agents per job and jobs per agent in a chain */
+#define	SCHEDULE 0	/* 0: restarts; 1, 2, 3: annealing with anneal.c */
+#define	LAGRANGE 300	/* subgradient iterations for the lower bound; 0: none */
 
 #define max( a, b ) ( ((a) > (b)) ? (a) : (b) )
 #define min( a, b ) ( ((a) < (b)) ? (a) : (b) )
@@ -43,6 +50,13 @@ typedef struct {
   int		givesol;	/* give a solution (1) or not (0) */
   /* Never modify the above two lines.  */
   /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
+  int		adaptive;	/* adapt the penalty weights per agent */
+  int		chain;		/* the longest ejection chain */
+  int		schedule;	/* the cooling schedule of the annealing */
+  int		lagrange;	/* subgradient iterations for the lower bound */
 } Param;			/* parameters */
 
 typedef struct {
@@ -71,13 +85,30 @@ void read_sol(Vdata *vdata, GAPdata *gapdata);
 void recompute_cost(Vdata *vdata, GAPdata *gapdata);
 void *malloc_e(size_t size);
 
-void random_init(int *sol, GAPdata *gapdata);
-bool neighbour(int *sol, GAPdata *gapdata, int *rest_b, int rp);
-bool shift(int *sol, GAPdata *gapdata, int *rest_b);
+#include "jobdata.c"
+#include "joblist.c"
+#include "eval.c"
+#include "penalty.c"
+#include "gapbin.c"
+#include "rng.c"
+#include "ejection.c"
+#include "movequeue.c"
+#include "deadline.c"
+#include "anneal.c"
+#include "lagrange.c"
+#include "fast_read.c"
+
+void random_init(int *sol, Rng *rng, GAPdata *gapdata);
+bool neighbour(Evaldata *ev, Rng *rng, GAPdata *gapdata, int rp);
+bool shift(Evaldata *ev, Rng *rng, GAPdata *gapdata);
 double probability(int e1, int e2, double t);
 int calculate_cost(int *sol, GAPdata *gapdata);
 bool is_feasible(int *rest_b, GAPdata *gapdata);
 
+#ifdef MICROBENCH
+#include "microbench.c"
+#endif
+
 /***** check the feasibility and recompute the cost **************************/
 /***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
 void recompute_cost(Vdata *vdata, GAPdata *gapdata)
@@ -143,6 +174,7 @@ void prepare_memory(Vdata *vdata, GAPdata *gapdata)
 void free_memory(Vdata *vdata, GAPdata *gapdata)
 {
   free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
   free((void *) gapdata->c[0]);
   free((void *) gapdata->c);
   free((void *) gapdata->a[0]);
@@ -205,6 +237,13 @@ void copy_parameters(int argc, char *argv[], Param *param)
   /**** copy the parameters ****/
   param->timelim = TIMELIM;
   param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
+  param->adaptive = ADAPTIVE;
+  param->chain = CHAIN;
+  param->schedule = SCHEDULE;
+  param->lagrange = LAGRANGE;
   /**** read the parameters ****/
   if(argc>0 && (argc % 2)==0){
     printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
@@ -213,6 +252,13 @@ void copy_parameters(int argc, char *argv[], Param *param)
     for(i=1; i<argc; i+=2){
       if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
       if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
+      if(strcmp(argv[i],"adaptive")==0) param->adaptive = atoi(argv[i+1]);
+      if(strcmp(argv[i],"chain")==0) param->chain = atoi(argv[i+1]);
+      if(strcmp(argv[i],"schedule")==0) param->schedule = atoi(argv[i+1]);
+      if(strcmp(argv[i],"lagrange")==0) param->lagrange = atoi(argv[i+1]);
     }
   }
 }
@@ -228,41 +274,42 @@ void *malloc_e( size_t size ) {
 }
 
 /***** subroutines ***********************************************/
-void random_init(int *sol, GAPdata *gapdata) {
-  for (int i=0; i<gapdata->n; i++) {
-    sol[i] = rand() % gapdata->m;
-  }
+void random_init(int *sol, Rng *rng, GAPdata *gapdata) {
+  rng_fill(rng, sol, gapdata->n, gapdata->m);
+}
+
+#ifdef MICROBENCH
+void microbench_random_init(int *sol, Rng *rng, const Jobdata *jd, GAPdata *gapdata) {
+  random_init(sol, rng, gapdata);
 }
+#endif
 
-bool neighbour(int *sol, GAPdata *gapdata, int *rest_b, int rp) {
-  int a, b, tmp, swap_cost, cur_cost;
+bool neighbour(Evaldata *ev, Rng *rng, GAPdata *gapdata, int rp) {
+  int a, b, sa, sb, swap_cost, cur_cost;
+  int *sol = ev->sol;
+  int *rest_b = ev->rest_b;
+  const Jobdata *jd = ev->jd;
   bool is_swap = false;
   for (int k=0; k<rp; k++) {
-    a = rand() % gapdata->n;
-    b = rand() % gapdata->n;
+    a = rng_int(rng, gapdata->n);
+    b = rng_int(rng, gapdata->n);
     if (a == b) continue;
+    sa = sol[a];
+    sb = sol[b];
     swap_cost
-      = gapdata->c[sol[b]][a]
-      + gapdata->c[sol[a]][b]
-      + INFEASIBLE_COST
-      * (max(0, gapdata->a[sol[b]][a] - rest_b[sol[b]])
-          + max(0, gapdata->a[sol[a]][b] - rest_b[sol[a]]));
+      = jobdata_c(jd, a, sb)
+      + jobdata_c(jd, b, sa)
+      + ev->weight[sb] * max(0, jobdata_a(jd, a, sb) - rest_b[sb])
+      + ev->weight[sa] * max(0, jobdata_a(jd, b, sa) - rest_b[sa]);
 
     cur_cost
-      = gapdata->c[sol[b]][b]
-      + gapdata->c[sol[a]][a]
-      + INFEASIBLE_COST
-      * (max(0, gapdata->a[sol[b]][b] - rest_b[sol[b]])
-          + max(0, gapdata->a[sol[a]][a] - rest_b[sol[a]]));
+      = jobdata_c(jd, b, sb)
+      + jobdata_c(jd, a, sa)
+      + ev->weight[sb] * max(0, jobdata_a(jd, b, sb) - rest_b[sb])
+      + ev->weight[sa] * max(0, jobdata_a(jd, a, sa) - rest_b[sa]);
 
     if (cur_cost > swap_cost) {
-      tmp = sol[b];
-
-      rest_b[tmp] += (gapdata->a[tmp][b] - gapdata->a[tmp][a]);
-      rest_b[sol[a]] += (gapdata->a[sol[a]][a] - gapdata->a[sol[a]][b]);
-
-      sol[b] = sol[a];
-      sol[a] = tmp;
+      eval_swap(ev, a, b);
       is_swap = true;
     }
   }
@@ -270,20 +317,25 @@ bool neighbour(int *sol, GAPdata *gapdata, int *rest_b, int rp) {
   return is_swap;
 }
 
-bool shift(int *sol, GAPdata *gapdata, int *rest_b) {
-  int shift, tmp;
+bool shift(Evaldata *ev, Rng *rng, GAPdata *gapdata) {
+  int shift, j;
+  int *rest_b = ev->rest_b;
+  const Jobdata *jd = ev->jd;
+  const Joblist *jl = ev->jobs;
   bool is_shift = false;
 
-  shift = rand() % gapdata->m;
-  for (int i=0; i<gapdata->n; i++) {
-    tmp = sol[i];
-    if (rest_b[tmp] > 0) continue;
-    if (gapdata->a[tmp][i] > gapdata->a[shift][i] || rest_b[shift] > gapdata->a[tmp][i]) {
-      sol[i] = shift;
-
-      rest_b[tmp] += gapdata->a[tmp][i];
-      rest_b[shift] -= gapdata->a[shift][i];
-      is_shift = true;
+  /* only the jobs of full agents move; a moved job leaves the list */
+  for (int i=0; i<gapdata->m; i++) {
+    for (int k=jl->count[i]-1; k>=0 && rest_b[i]<=0; k--) {
+      j = joblist_job(jl, i, k);
+#ifdef MICROBENCH
+      microbench_visits++;
+#endif
+      shift = jd->by_ratio[j * jd->k + rng_int(rng, jd->k)];
+      if (jobdata_a(jd, j, i) > jobdata_a(jd, j, shift) || rest_b[shift] > jobdata_a(jd, j, i)) {
+        eval_move(ev, j, shift);
+        is_shift = true;
+      }
     }
   }
 
@@ -321,14 +373,26 @@ int main(int argc, char *argv[])
   Param		param;		/* parameters */
   GAPdata	gapdata;	/* GAP instance data */
   Vdata		vdata;		/* various data often needed during search */
+  Rng		rng;		/* random number generator of the search */
+  Deadline	dl;		/* the time limit of the search */
 
   vdata.timebrid = cpu_time();
   copy_parameters(argc, argv, &param);
-  read_instance(&gapdata);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
   prepare_memory(&vdata, &gapdata);
   if(param.givesol==1){read_sol(&vdata, &gapdata);}
   vdata.starttime = cpu_time();
 
+#ifdef MICROBENCH
+  microbench(&gapdata, param.seed, microbench_random_init, "random_init");
+  free_memory(&vdata, &gapdata);
+  return EXIT_SUCCESS;
+#endif
+
   /*
      Write your program here. Of course you can add your subroutines
      outside main(). At this point, the instance data is stored in "gapdata".
@@ -361,6 +425,22 @@ int main(int argc, char *argv[])
 
   int *bestsol = (int *) malloc_e(gapdata.n * sizeof(int));
   int *rest_b = (int *) malloc_e(gapdata.m * sizeof(int));
+  Jobdata jd;
+  Evaldata ev;
+  Penalty pen;
+  Ejection ej;
+  Joblist jl;
+  Movequeue mq;
+
+  jobdata_build(&jd, &gapdata);
+  joblist_init(&jl, gapdata.m, gapdata.n);
+  ejection_init(&ej, param.chain, CHAIN_WIDTH, &jd);
+  movequeue_init(&mq, &jd);
+  if (param.adaptive) {
+    penalty_init(&pen, gapdata.m, INFEASIBLE_COST, 1, 100 * INFEASIBLE_COST);
+  } else {
+    penalty_init(&pen, gapdata.m, INFEASIBLE_COST, INFEASIBLE_COST, INFEASIBLE_COST);
+  }
 
   int highest_cost = INT_MAX;
   int *highestsol = (int *) malloc_e(gapdata.n * sizeof(int));
@@ -370,51 +450,74 @@ int main(int argc, char *argv[])
   const double T1 = 500;
   double t; // logarithmic cooling
 
-  while ((cpu_time() - vdata.starttime) < param.timelim) {
+  /* stop as soon as the best feasible solution reaches the lower bound */
+  Lagrange lg;
+  int bound = INT_MIN;
+
+  deadline_init(&dl, vdata.starttime, param.timelim);
+  if (param.lagrange > 0) {
+    lagrange_init(&lg, &gapdata);
+    bound = lagrange_start(&lg, &gapdata, param.lagrange, &dl);
+    printf("lower bound = %d (%d iterations)\n", bound, lg.iter);
+  }
+
+  /* one annealing run over the whole time limit instead of restarts */
+  if (param.schedule > 0) {
+    Anneal an;
+
+    rng_seed(&rng, param.seed, 0);
+    random_init(bestsol, &rng, &gapdata);
+    eval_init(&ev, bestsol, rest_b, pen.weight, &jd, &gapdata);
+    anneal_init(&an, param.schedule);
+    an.report = true;
+    anneal_calibrate(&an, &ev, &rng);
+    highest_cost = anneal_run(&an, &ev, &rng, &pen, &dl, highestsol, highest_cost, bound);
+    printf("annealing: %ld moves, %.1f%% accepted, t0 = %.2f, t1 = %.4f, %d reheats\n",
+        an.moves, 100.0 * an.accepted / max(1, an.moves), an.t0, an.t1, an.reheats);
+  }
+
+  while (!deadline_over(&dl) && highest_cost > bound) {
     count++;
-    srand(count);
+    rng_seed(&rng, param.seed, count);
  
-    random_init(bestsol, &gapdata);
-    pre_cost = calculate_cost(bestsol, &gapdata);
+    random_init(bestsol, &rng, &gapdata);
+    eval_init(&ev, bestsol, rest_b, pen.weight, &jd, &gapdata);
+    eval_jobs(&ev, &jl);
+    pre_cost = eval_value(&ev);
     impr = 0;
-
-    for (int i=0; i<gapdata.m; i++) rest_b[i] = gapdata.b[i];
-    for (int i=0; i<gapdata.n; i++) {
-      rest_b[bestsol[i]] -= gapdata.a[bestsol[i]][i];
-    }
-
-    for (int i=0; i<gapdata.m; i++) {
-      pre_cost -= INFEASIBLE_COST * min(0, rest_b[i]);
-    }
     new_cost = pre_cost;
 
-    while(impr < impr_lim) {
-      is_swap = neighbour(bestsol, &gapdata, rest_b, 1);
-      if (best_cost == INT_MAX) {
-        is_swap = is_swap || shift(bestsol, &gapdata, rest_b);
-      }
+    /* neighbour() may undo a chain, so there are at most m rounds */
+    for (int chains=0; ; chains++) {
+      while(impr < impr_lim) {
+        is_swap = neighbour(&ev, &rng, &gapdata, 1);
+        if (best_cost == INT_MAX) {
+          is_swap = is_swap || shift(&ev, &rng, &gapdata);
+        }
 
-      if (is_swap) {
-        new_cost = 0;
-        for (int j=0; j<gapdata.n; j++) {
-          new_cost += gapdata.c[bestsol[j]][j];
+        if (is_swap) {
+          new_cost = eval_value(&ev);
         }
-        for (int i=0; i<gapdata.m; i++) {
-          new_cost -= INFEASIBLE_COST * min(0, rest_b[i]);
+
+        if (new_cost >= pre_cost) {
+          impr++;
+        } else {
+          pre_cost = new_cost;
+          impr = 0;
         }
       }
 
-      if (new_cost >= pre_cost) {
-        impr++;
-      } else {
-        pre_cost = new_cost;
-        impr = 0;
-      }
+      /* random moves are stuck: make the best shifts, then try a chain */
+      if (chains == gapdata.m) break;
+      if (movequeue_descent(&mq, &ev) == 0 && !ejection_chain(&ej, &ev, &rng)) break;
+      pre_cost = new_cost = eval_value(&ev);
+      impr = 0;
     }
+    penalty_update(&pen, &ev, gapdata.m);
 
     if (is_feasible(rest_b, &gapdata)) {
       t = T1 / log2(1+count); // Logarithmic cooling
-      if ((double)(rand()) / RAND_MAX <= probability(new_cost, best_cost, t)) {
+      if (rng_double(&rng) <= probability(new_cost, best_cost, t)) {
         for (int i=0; i<gapdata.n; i++) {
           vdata.bestsol[i] = bestsol[i];
         }
@@ -423,13 +526,18 @@ int main(int argc, char *argv[])
 
       if (best_cost < highest_cost) {
         highest_cost = best_cost;
+        deadline_best(&dl, highest_cost);
         for (int i=0; i<gapdata.n; i++) {
           highestsol[i] = vdata.bestsol[i];
         }
+        /* a real upper bound makes the subgradient steps much better */
+        if (param.lagrange > 0) {
+          bound = lagrange_update(&lg, &gapdata, highest_cost, &dl);
+        }
       }
     }
 
-    // printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, (cpu_time() - vdata.starttime));
+    // printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, deadline_elapsed(&dl));
   }
 
   if (highest_cost < best_cost) {
@@ -438,9 +546,34 @@ int main(int argc, char *argv[])
     }
   }
 
+  /* no feasible solution: the greedy start or the last solution searched,
+     whichever exceeds the capacities less */
+  if (highest_cost == INT_MAX) {
+    int excess = INT_MAX;
+    if (count > 0 || param.schedule > 0) {
+      eval_init(&ev, bestsol, rest_b, pen.weight, &jd, &gapdata);
+      excess = ev.excess;
+    }
+    jobdata_greedy(&jd, gapdata.b, highestsol);
+    eval_init(&ev, highestsol, rest_b, pen.weight, &jd, &gapdata);
+    for (int i=0; i<gapdata.n; i++) {
+      vdata.bestsol[i] = (ev.excess <= excess) ? highestsol[i] : bestsol[i];
+    }
+  }
+
+  if (param.lagrange > 0) {
+    printf("lower bound = %d (%d iterations)\n", bound, lg.iter);
+    lagrange_free(&lg);
+  }
+
   vdata.endtime = cpu_time();
   recompute_cost(&vdata, &gapdata);
   free_memory(&vdata, &gapdata);
+  jobdata_free(&jd);
+  penalty_free(&pen);
+  ejection_free(&ej);
+  joblist_free(&jl);
+  movequeue_free(&mq);
   free((void *) rest_b);
   free((void *) bestsol);
 
@@ -0,0 +1,547 @@
+/******************************************************************************
+  A template program for developing a GAP solver. Subroutines to read instance
+  data and compute the cost of a given solution are included.
+
+  This program can also be used to compute the cost and check the feasibility
+  of a solution given from a file. The format of a file is:
+  for each job j from 1 to n in this order, the index of the agent (the value
+  should be given as values from [1, m]) to which j is assigned. For example,
+  if n=4 and m=3, and jobs 1, 2, 3 and 4 are assigned to agents 2, 1, 3 and 1,
+  respectively, then the data in the file should be as follows:  2 1 3 1.
+
+NOTE: Index i of agents ranges from 0 to m-1, and
+index j of jobs   ranges from 0 to n-1 in the program,
+while in the solution file,
+index i of agents ranges from 1 to m, and
+index j of jobs   ranges from 1 to n in the program.
+Sorry for the confusion.
+
+If you would like to use various parameters, it might be useful to modify
+the definition of struct "Param" and mimic the way the default value of
+"timelim" is given and how its value is input from the command line.
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include "cpu_time.c"
+
+/***** default values of parameters ******************************************/
+#define	TIMELIM	300	/* the time limit for the algorithm in seconds */
+#define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	LAGRANGE 300	/* subgradient iterations for the lower bound; 0: none */
+#define	MULTIPLIERS 1000 /* subgradient iterations for the node bound */
+
+#define max( a, b ) ( ((a) > (b)) ? (a) : (b) )
+#define min( a, b ) ( ((a) < (b)) ? (a) : (b) )
+
+typedef struct {
+  int		timelim;	/* the time limit for the algorithm in secs. */
+  int		givesol;	/* give a solution (1) or not (0) */
+  /* Never modify the above two lines.  */
+  /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		lagrange;	/* subgradient iterations for the lower bound */
+  int		multipliers;	/* subgradient iterations for the node bound */
+} Param;			/* parameters */
+
+typedef struct {
+  int	n;	/* number of jobs */
+  int	m;	/* number of agents */
+  int	**c;	/* cost matrix c_{ij} */
+  int	**a;	/* resource requirement matrix a_{ij} */
+  int	*b;	/* available amount b_i of resource for each agent i */
+} GAPdata;	/* data of the generalized assignment problem */
+
+typedef struct {
+  double	timebrid;	/* the time before reading the instance data */
+  double	starttime;	/* the time the search started */
+  double	endtime;	/* the time the search ended */
+  int		*bestsol;	/* the best solution found so far */
+  /* Never modify the above four lines. */
+  /* You can add more components below. */
+} Vdata;		/* various data often necessary during the search */
+
+/*************************** functions ***************************************/
+void copy_parameters(int argc, char *arcv[], Param *param);
+void read_instance(GAPdata *gapdata);
+void prepare_memory(Vdata *vdata, GAPdata *gapdata);
+void free_memory(Vdata *vdata, GAPdata *gapdata);
+void read_sol(Vdata *vdata, GAPdata *gapdata);
+void recompute_cost(Vdata *vdata, GAPdata *gapdata);
+void *malloc_e(size_t size);
+
+#include "gapbin.c"
+#include "deadline.c"
+#include "lagrange.c"
+#include "fast_read.c"
+
+typedef struct {
+  GAPdata	*gapdata;
+  double	*v;		/* multipliers of the capacity constraints */
+  double	*rc;		/* rc[j*m + i] = c_{ij} + v_i a_{ij} */
+  int		*agents;	/* agents[j*m + k]: the k-th agent of job j by rc */
+  int		*order;		/* the jobs in the order they are fixed */
+  int		*sol;		/* the agents of the fixed jobs */
+  int		*rest_b;	/* the amount of resource left at each agent */
+  int		cost;		/* the cost of the fixed jobs */
+  int		*bestsol;	/* the best solution found so far */
+  int		best;		/* its cost; INT_MAX if none */
+  int		stop;		/* the search may stop at this cost */
+  Lagrange	*lg;		/* raises stop when the incumbent improves */
+  long		nodes;		/* nodes visited so far */
+  Deadline	*dl;		/* the time limit of the search */
+  bool		timeout;	/* the search was stopped by the time limit */
+} BBdata;			/* data of the branch-and-bound search */
+
+void bb_multipliers(BBdata *bb, int iters);
+void bb_order(BBdata *bb);
+void bb_greedy(BBdata *bb);
+double bb_lower_bound(BBdata *bb, int depth);
+void bb_search(BBdata *bb, int depth);
+
+/***** check the feasibility and recompute the cost **************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void recompute_cost(Vdata *vdata, GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	*rest_b;	/* the amount of resource available at each agent */
+  int	cost, penal;	/* the cost; the penalty = the total capacity excess */
+  int	temp;		/* temporary variable */
+
+  rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  cost = penal = 0;
+  for(i=0; i<gapdata->m; i++){rest_b[i] = gapdata->b[i];}
+  for(j=0; j<gapdata->n; j++){
+    rest_b[vdata->bestsol[j]] -= gapdata->a[vdata->bestsol[j]][j];
+    cost += gapdata->c[vdata->bestsol[j]][j];
+  }
+  for(i=0; i<gapdata->m; i++){
+    temp = rest_b[i];
+    if(temp<0){penal -= temp;}
+  }
+  printf("recomputed cost = %d\n", cost);
+  if(penal>0){
+    printf("INFEASIBLE!!\n");
+    printf(" resource left:");
+    for(i=0; i<gapdata->m; i++){printf(" %3d", rest_b[i]);}
+    printf("\n");
+  }
+  printf("time for the search:       %7.2f seconds\n",
+      vdata->endtime - vdata->starttime);
+  printf("time to read the instance: %7.2f seconds\n",
+      vdata->starttime - vdata->timebrid);
+
+  free((void *) rest_b);
+}
+
+/***** read a solution from STDIN ********************************************/
+void read_sol(Vdata *vdata, GAPdata *gapdata)
+{
+  int	j;		/* index of jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  for(j=0; j<gapdata->n; j++){
+    fscanf(fp, "%d", &value_read);
+    /* change the range of agents from [1, m] to [0, m-1] */
+    vdata->bestsol[j] = value_read - 1;
+  }
+}
+
+/***** prepare memory space **************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void prepare_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  int j;
+
+  vdata->bestsol = (int *)  malloc_e(gapdata->n * sizeof(int));
+  /* the next line is just to avoid confusion */
+  for(j=0; j<gapdata->n; j++){vdata->bestsol[j] = 0;}
+}
+
+/***** free memory space *****************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void free_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
+  free((void *) gapdata->c[0]);
+  free((void *) gapdata->c);
+  free((void *) gapdata->a[0]);
+  free((void *) gapdata->a);
+  free((void *) gapdata->b);
+}
+
+/***** read the instance data ************************************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void read_instance(GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  /* read the number of agents and jobs */
+  fscanf(fp, "%d", &value_read);	/* number of agents */
+  gapdata->m = value_read;
+  fscanf(fp,"%d",&value_read);		/* number of jobs */
+  gapdata->n = value_read;
+
+  /* initialize memory */
+  gapdata->c    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->c[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->c[i] = gapdata->c[i-1] + gapdata->n;}
+  gapdata->a    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->a[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->a[i] = gapdata->a[i-1] + gapdata->n;}
+  gapdata->b    = (int *)  malloc_e(gapdata->m * sizeof(int));
+
+  /* read the cost coefficients */   
+  for(i=0; i<gapdata->m; i++){    
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->c[i][j] = value_read;
+    }
+  }
+
+  /* read the resource consumption */
+  for(i=0; i<gapdata->m; i++){
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->a[i][j] = value_read;
+    }
+  }
+
+  /* read the resource capacity */
+  for(i=0; i<gapdata->m; i++){    
+    fscanf(fp,"%d", &value_read);
+    gapdata->b[i] = value_read;
+  }
+}
+
+/***** copy and read the parameters ******************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void copy_parameters(int argc, char *argv[], Param *param)
+{
+  int i;
+
+  /**** copy the parameters ****/
+  param->timelim = TIMELIM;
+  param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->lagrange = LAGRANGE;
+  param->multipliers = MULTIPLIERS;
+  /**** read the parameters ****/
+  if(argc>0 && (argc % 2)==0){
+    printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
+    exit(EXIT_FAILURE);}
+  else{
+    for(i=1; i<argc; i+=2){
+      if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
+      if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"lagrange")==0) param->lagrange = atoi(argv[i+1]);
+      if(strcmp(argv[i],"multipliers")==0) param->multipliers = atoi(argv[i+1]);
+    }
+  }
+}
+
+/***** malloc with error check ***********************************************/
+void *malloc_e( size_t size ) {
+  void *s;
+  if ( (s=malloc(size)) == NULL ) {
+    fprintf( stderr, "malloc : Not enough memory.\n" );
+    exit( EXIT_FAILURE );
+  }
+  return s;
+}
+
+
+/***** subroutines ***********************************************/
+/***** multipliers v of the capacity constraints by subgradient steps ********/
+void bb_multipliers(BBdata *bb, int iters) {
+  GAPdata *gapdata = bb->gapdata;
+  int m = gapdata->m, n = gapdata->n;
+  double *v = bb->v;
+  double *bestv = (double *) malloc_e(m * sizeof(double));
+  double *g = (double *) malloc_e(m * sizeof(double));
+  double value, best = -HUGE_VAL, lambda = 2.0, norm, step, target, r, rmin;
+  int imin, since = 0;
+
+  for (int i=0; i<m; i++) v[i] = bestv[i] = 0.0;
+
+  for (int k=0; k<iters && lambda > 1e-6; k++) {
+    /* L(v) = sum_j min_i (c_{ij} + v_i a_{ij}) - sum_i v_i b_i */
+    value = 0.0;
+    for (int i=0; i<m; i++) {
+      value -= v[i] * gapdata->b[i];
+      g[i] = -gapdata->b[i];
+    }
+    for (int j=0; j<n; j++) {
+      rmin = HUGE_VAL;
+      imin = 0;
+      for (int i=0; i<m; i++) {
+        r = gapdata->c[i][j] + v[i] * gapdata->a[i][j];
+        if (r < rmin) {
+          rmin = r;
+          imin = i;
+        }
+      }
+      value += rmin;
+      g[imin] += gapdata->a[imin][j];
+    }
+
+    if (value > best + 1e-9) {
+      best = value;
+      for (int i=0; i<m; i++) bestv[i] = v[i];
+      since = 0;
+    } else if (++since >= 20) {
+      lambda /= 2;
+      since = 0;
+    }
+
+    /* the projection onto v >= 0 drops the components that stay at 0 */
+    norm = 0.0;
+    for (int i=0; i<m; i++) {
+      if (v[i] > 0 || g[i] > 0) norm += g[i] * g[i];
+    }
+    if (norm == 0.0) break;
+    target = (bb->best < INT_MAX) ? bb->best : best + fabs(best) * 0.05 + 1.0;
+    step = lambda * (target - value) / norm;
+    for (int i=0; i<m; i++) v[i] = max(0.0, v[i] + step * g[i]);
+  }
+
+  for (int i=0; i<m; i++) v[i] = bestv[i];
+  for (int j=0; j<n; j++) {
+    for (int i=0; i<m; i++) {
+      bb->rc[j*m + i] = gapdata->c[i][j] + v[i] * gapdata->a[i][j];
+    }
+  }
+  free((void *) bestv);
+  free((void *) g);
+}
+
+static double *bb_regret;	/* the key of bb_cmp_regret() */
+
+static int bb_cmp_regret(const void *x, const void *y) {
+  double d = bb_regret[*(const int *) y] - bb_regret[*(const int *) x];
+  return (d > 0) - (d < 0);
+}
+
+/***** sort the agents of every job by rc, and the jobs by regret ************/
+void bb_order(BBdata *bb) {
+  int m = bb->gapdata->m, n = bb->gapdata->n;
+  double *regret = (double *) malloc_e(n * sizeof(double));
+  int *agents, tmp, k;
+
+  for (int j=0; j<n; j++) {
+    agents = bb->agents + j*m;
+    for (int i=0; i<m; i++) {
+      tmp = i;
+      for (k=i; k>0 && bb->rc[j*m + agents[k-1]] > bb->rc[j*m + tmp]; k--) {
+        agents[k] = agents[k-1];
+      }
+      agents[k] = tmp;
+    }
+    /* the jobs that lose most when they miss their best agent come first */
+    regret[j] = (m > 1) ? bb->rc[j*m + agents[1]] - bb->rc[j*m + agents[0]] : 0.0;
+    bb->order[j] = j;
+  }
+
+  bb_regret = regret;
+  qsort(bb->order, n, sizeof(int), bb_cmp_regret);
+  free((void *) regret);
+}
+
+/***** assign the jobs in order to their best agent with room left ***********/
+void bb_greedy(BBdata *bb) {
+  GAPdata *gapdata = bb->gapdata;
+  int m = gapdata->m, n = gapdata->n;
+  int cost = 0, i = 0, j, k;
+
+  for (i=0; i<m; i++) bb->rest_b[i] = gapdata->b[i];
+  for (int d=0; d<n; d++) {
+    j = bb->order[d];
+    for (k=0; k<m; k++) {
+      i = bb->agents[j*m + k];
+      if (gapdata->a[i][j] <= bb->rest_b[i]) break;
+    }
+    if (k == m) break;
+    bb->sol[j] = i;
+    bb->rest_b[i] -= gapdata->a[i][j];
+    cost += gapdata->c[i][j];
+    if (d == n-1) {
+      for (j=0; j<n; j++) bb->bestsol[j] = bb->sol[j];
+      bb->best = cost;
+      deadline_best(bb->dl, cost);
+    }
+  }
+  for (i=0; i<m; i++) bb->rest_b[i] = gapdata->b[i];
+}
+
+/***** a lower bound of the solutions below the current node *****************/
+double bb_lower_bound(BBdata *bb, int depth) {
+  GAPdata *gapdata = bb->gapdata;
+  int m = gapdata->m;
+  double lb = bb->cost;
+  int i, j, k;
+
+  for (i=0; i<m; i++) lb -= bb->v[i] * bb->rest_b[i];
+  for (int d=depth; d<gapdata->n; d++) {
+    j = bb->order[d];
+    for (k=0; k<m; k++) {
+      i = bb->agents[j*m + k];
+      if (gapdata->a[i][j] <= bb->rest_b[i]) break;
+    }
+    if (k == m) return HUGE_VAL;
+    lb += bb->rc[j*m + i];
+  }
+  return lb;
+}
+
+/***** depth-first search below the node where order[0..depth-1] are fixed **/
+void bb_search(BBdata *bb, int depth) {
+  GAPdata *gapdata = bb->gapdata;
+  int m = gapdata->m, n = gapdata->n;
+  int i, j;
+
+  bb->nodes++;
+  if (bb->timeout || bb->best <= bb->stop) return;
+  if (deadline_over(bb->dl)) {
+    bb->timeout = true;
+    return;
+  }
+  if (depth == n) {
+    if (bb->cost < bb->best) {
+      for (j=0; j<n; j++) bb->bestsol[j] = bb->sol[j];
+      bb->best = bb->cost;
+      deadline_best(bb->dl, bb->best);
+      if (bb->lg != NULL) bb->stop = lagrange_update(bb->lg, gapdata, bb->best, bb->dl);
+    }
+    return;
+  }
+  /* costs are integers, so a bound above best - 1 cannot improve */
+  if (bb_lower_bound(bb, depth) > bb->best - 1 + 1e-6) return;
+
+  j = bb->order[depth];
+  for (int k=0; k<m; k++) {
+    i = bb->agents[j*m + k];
+    if (gapdata->a[i][j] > bb->rest_b[i]) continue;
+    bb->sol[j] = i;
+    bb->rest_b[i] -= gapdata->a[i][j];
+    bb->cost += gapdata->c[i][j];
+    bb_search(bb, depth+1);
+    bb->rest_b[i] += gapdata->a[i][j];
+    bb->cost -= gapdata->c[i][j];
+  }
+}
+
+/***** main ******************************************************************/
+int main(int argc, char *argv[])
+{
+  Param		param;		/* parameters */
+  GAPdata	gapdata;	/* GAP instance data */
+  Vdata		vdata;		/* various data often needed during search */
+  Deadline	dl;		/* the time limit of the search */
+
+  vdata.timebrid = cpu_time();
+  copy_parameters(argc, argv, &param);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
+  prepare_memory(&vdata, &gapdata);
+  if(param.givesol==1){read_sol(&vdata, &gapdata);}
+  vdata.starttime = cpu_time();
+
+  /*
+     Write your program here. Of course you can add your subroutines
+     outside main(). At this point, the instance data is stored in "gapdata".
+     gapdata.n	number of jobs n
+     gapdata.m	number of agents m
+     gapdata.c[i][j]	cost c_{ij} {i, j} = {agent, job} 
+     gapdata.a[i][j]	resource requirement a_{ij} 
+     gapdata.b[i]	available amount b_i of resource at agent i
+     Note that i ranges from 0 to m-1, and j ranges from 0 to n-1. Note also
+     that  you should write, e.g., "gapdata->c[i][j]" in your subroutines.
+     Store your best solution in vdata.bestsol, then "recompute_cost" will
+     compute its cost and its feasibility. The format of vdata.bestsol is:
+     For each job j from 0 to n-1 in this order, the index of the agent 
+     (the value should be given as values from [0, m-1]) to which j is
+     assigned. For example, if n=4 and m=3, and jobs 0, 1, 2 and 3 are
+     assigned to agents 1, 0, 2 and 0, respectively, then vdata.bestsol
+     should be as follows:  
+     vdata.bestsol[0] = 1
+     vdata.bestsol[1] = 0
+     vdata.bestsol[2] = 2
+     vdata.bestsol[3] = 0.
+     Note that you should write "vdata->bestsol[j]" in your subroutines.
+     */
+
+  BBdata bb;
+  Lagrange lg;
+  int bound = INT_MIN;
+  double t;
+
+  bb.gapdata = &gapdata;
+  bb.v = (double *) malloc_e(gapdata.m * sizeof(double));
+  bb.rc = (double *) malloc_e(gapdata.n * gapdata.m * sizeof(double));
+  bb.agents = (int *) malloc_e(gapdata.n * gapdata.m * sizeof(int));
+  bb.order = (int *) malloc_e(gapdata.n * sizeof(int));
+  bb.sol = (int *) malloc_e(gapdata.n * sizeof(int));
+  bb.rest_b = (int *) malloc_e(gapdata.m * sizeof(int));
+  bb.bestsol = vdata.bestsol;
+  bb.best = INT_MAX;
+  bb.cost = 0;
+  bb.nodes = 0;
+  bb.dl = &dl;
+  bb.timeout = false;
+
+  deadline_init(&dl, vdata.starttime, param.timelim);
+
+  /* the Lagrangian bound only tells when the incumbent is optimal */
+  bb.lg = NULL;
+  if (param.lagrange > 0) {
+    lagrange_init(&lg, &gapdata);
+    bound = lagrange_start(&lg, &gapdata, param.lagrange, &dl);
+    bb.lg = &lg;
+  }
+  bb.stop = bound;
+
+  bb_multipliers(&bb, param.multipliers);
+  bb_order(&bb);
+  bb_greedy(&bb);
+  if (bb.lg != NULL && bb.best < INT_MAX) {
+    bb.stop = lagrange_update(&lg, &gapdata, bb.best, &dl);
+  }
+  printf("lower bound = %d\n", bb.stop);
+
+  t = cpu_time();
+  bb_search(&bb, 0);
+  t = cpu_time() - t;
+
+  printf("nodes = %ld (%.0f nodes/s), cost = %d, %s\n", bb.nodes,
+      t > 0 ? bb.nodes / t : 0.0, bb.best,
+      bb.timeout ? "time limit reached" : "optimal");
+  if (bb.lg != NULL) lagrange_free(&lg);
+
+  vdata.endtime = cpu_time();
+  recompute_cost(&vdata, &gapdata);
+  free_memory(&vdata, &gapdata);
+  free((void *) bb.v);
+  free((void *) bb.rc);
+  free((void *) bb.agents);
+  free((void *) bb.order);
+  free((void *) bb.sol);
+  free((void *) bb.rest_b);
+
+  return EXIT_SUCCESS;
+}
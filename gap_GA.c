@@ -0,0 +1,543 @@
+/******************************************************************************
+  A template program for developing a GAP solver. Subroutines to read instance
+  data and compute the cost of a given solution are included.
+
+  This program can also be used to compute the cost and check the feasibility
+  of a solution given from a file. The format of a file is:
+  for each job j from 1 to n in this order, the index of the agent (the value
+  should be given as values from [1, m]) to which j is assigned. For example,
+  if n=4 and m=3, and jobs 1, 2, 3 and 4 are assigned to agents 2, 1, 3 and 1,
+  respectively, then the data in the file should be as follows:  2 1 3 1.
+
+NOTE: Index i of agents ranges from 0 to m-1, and
+index j of jobs   ranges from 0 to n-1 in the program,
+while in the solution file,
+index i of agents ranges from 1 to m, and
+index j of jobs   ranges from 1 to n in the program.
+Sorry for the confusion.
+
+If you would like to use various parameters, it might be useful to modify
+the definition of struct "Param" and mimic the way the default value of
+"timelim" is given and how its value is input from the command line.
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include "cpu_time.c"
+
+/***** default values of parameters ******************************************/
+#define	TIMELIM	300	/* the time limit for the algorithm in seconds */
+#define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
+#define	ISLANDS	4	/* islands, each evolved by a thread of its own */
+#define	POPULATION 30	/* solutions per island */
+#define	CROSSOVER 1	/* 0: uniform; 1: agent-preserving */
+#define	MIGRATION 50	/* generations between two migrations */
+#define	MUTATION 0.01	/* the fraction of jobs of a child moved at random */
+#define	RING	4	/* migrants in flight from one island to the next */
+
+#define max( a, b ) ( ((a) > (b)) ? (a) : (b) )
+#define min( a, b ) ( ((a) < (b)) ? (a) : (b) )
+
+const int INFEASIBLE_COST = 20;
+
+typedef struct {
+  int		timelim;	/* the time limit for the algorithm in secs. */
+  int		givesol;	/* give a solution (1) or not (0) */
+  /* Never modify the above two lines.  */
+  /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
+  int		islands;	/* islands, each evolved by a thread of its own */
+  int		population;	/* solutions per island */
+  int		crossover;	/* 0: uniform; 1: agent-preserving */
+  int		migration;	/* generations between two migrations */
+} Param;			/* parameters */
+
+typedef struct {
+  int	n;	/* number of jobs */
+  int	m;	/* number of agents */
+  int	**c;	/* cost matrix c_{ij} */
+  int	**a;	/* resource requirement matrix a_{ij} */
+  int	*b;	/* available amount b_i of resource for each agent i */
+} GAPdata;	/* data of the generalized assignment problem */
+
+typedef struct {
+  double	timebrid;	/* the time before reading the instance data */
+  double	starttime;	/* the time the search started */
+  double	endtime;	/* the time the search ended */
+  int		*bestsol;	/* the best solution found so far */
+  /* Never modify the above four lines. */
+  /* You can add more components below. */
+} Vdata;		/* various data often necessary during the search */
+
+/*************************** functions ***************************************/
+void copy_parameters(int argc, char *arcv[], Param *param);
+void read_instance(GAPdata *gapdata);
+void prepare_memory(Vdata *vdata, GAPdata *gapdata);
+void free_memory(Vdata *vdata, GAPdata *gapdata);
+void read_sol(Vdata *vdata, GAPdata *gapdata);
+void recompute_cost(Vdata *vdata, GAPdata *gapdata);
+void *malloc_e(size_t size);
+
+#include "jobdata.c"
+#include "joblist.c"
+#include "eval.c"
+#include "gapbin.c"
+#include "rng.c"
+#include "deadline.c"
+#include "movequeue.c"
+#include "incumbent.c"
+#include "spsc.c"
+#include "fast_read.c"
+
+void repair(Evaldata *ev);
+int tournament(const int *value, int size, Rng *rng);
+void crossover(int *child, const int *pa, const int *pb, char *mask,
+    Rng *rng, Param *param, GAPdata *gapdata);
+void *island(void *arg);
+
+/* the counters of one island, written by its thread only; a cache line */
+/* each, so that the islands do not write to the lines of one another */
+typedef struct {
+  _Alignas(64) long	generations;	/* generations of the island */
+  long		migrants;	/* migrants taken into the island */
+} Islandslot;
+
+typedef struct {
+  GAPdata	*gapdata;	/* the instance, shared read-only */
+  const Jobdata	*jd;
+  Param		*param;
+  Incumbent	*inc;		/* the best solution of all islands */
+  Spsc		*ring;		/* ring[k]: the migrants from island k to k+1 */
+  Islandslot	*slot;		/* slot[k]: the counters of island k */
+  _Atomic int	next;		/* the next island number to take */
+} Archipelago;
+
+static int improve(Evaldata *ev, int *sol, int *rest_b, int *weight,
+    Joblist *jl, Movequeue *mq, Archipelago *ar);
+
+/***** check the feasibility and recompute the cost **************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void recompute_cost(Vdata *vdata, GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	*rest_b;	/* the amount of resource available at each agent */
+  int	cost, penal;	/* the cost; the penalty = the total capacity excess */
+  int	temp;		/* temporary variable */
+
+  rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  cost = penal = 0;
+  for(i=0; i<gapdata->m; i++){rest_b[i] = gapdata->b[i];}
+  for(j=0; j<gapdata->n; j++){
+    rest_b[vdata->bestsol[j]] -= gapdata->a[vdata->bestsol[j]][j];
+    cost += gapdata->c[vdata->bestsol[j]][j];
+  }
+  for(i=0; i<gapdata->m; i++){
+    temp = rest_b[i];
+    if(temp<0){penal -= temp;}
+  }
+  printf("recomputed cost = %d\n", cost);
+  if(penal>0){
+    printf("INFEASIBLE!!\n");
+    printf(" resource left:");
+    for(i=0; i<gapdata->m; i++){printf(" %3d", rest_b[i]);}
+    printf("\n");
+  }
+  printf("time for the search:       %7.2f seconds\n",
+      vdata->endtime - vdata->starttime);
+  printf("time to read the instance: %7.2f seconds\n",
+      vdata->starttime - vdata->timebrid);
+
+  free((void *) rest_b);
+}
+
+/***** read a solution from STDIN ********************************************/
+void read_sol(Vdata *vdata, GAPdata *gapdata)
+{
+  int	j;		/* index of jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  for(j=0; j<gapdata->n; j++){
+    fscanf(fp, "%d", &value_read);
+    /* change the range of agents from [1, m] to [0, m-1] */
+    vdata->bestsol[j] = value_read - 1;
+  }
+}
+
+/***** prepare memory space **************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void prepare_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  int j;
+
+  vdata->bestsol = (int *)  malloc_e(gapdata->n * sizeof(int));
+  /* the next line is just to avoid confusion */
+  for(j=0; j<gapdata->n; j++){vdata->bestsol[j] = 0;}
+}
+
+/***** free memory space *****************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void free_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
+  free((void *) gapdata->c[0]);
+  free((void *) gapdata->c);
+  free((void *) gapdata->a[0]);
+  free((void *) gapdata->a);
+  free((void *) gapdata->b);
+}
+
+/***** read the instance data ************************************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void read_instance(GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  /* read the number of agents and jobs */
+  fscanf(fp, "%d", &value_read);	/* number of agents */
+  gapdata->m = value_read;
+  fscanf(fp,"%d",&value_read);		/* number of jobs */
+  gapdata->n = value_read;
+
+  /* initialize memory */
+  gapdata->c    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->c[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->c[i] = gapdata->c[i-1] + gapdata->n;}
+  gapdata->a    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->a[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->a[i] = gapdata->a[i-1] + gapdata->n;}
+  gapdata->b    = (int *)  malloc_e(gapdata->m * sizeof(int));
+
+  /* read the cost coefficients */   
+  for(i=0; i<gapdata->m; i++){    
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->c[i][j] = value_read;
+    }
+  }
+
+  /* read the resource consumption */
+  for(i=0; i<gapdata->m; i++){
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->a[i][j] = value_read;
+    }
+  }
+
+  /* read the resource capacity */
+  for(i=0; i<gapdata->m; i++){    
+    fscanf(fp,"%d", &value_read);
+    gapdata->b[i] = value_read;
+  }
+}
+
+/***** copy and read the parameters ******************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void copy_parameters(int argc, char *argv[], Param *param)
+{
+  int i;
+
+  /**** copy the parameters ****/
+  param->timelim = TIMELIM;
+  param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
+  param->islands = ISLANDS;
+  param->population = POPULATION;
+  param->crossover = CROSSOVER;
+  param->migration = MIGRATION;
+  /**** read the parameters ****/
+  if(argc>0 && (argc % 2)==0){
+    printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
+    exit(EXIT_FAILURE);}
+  else{
+    for(i=1; i<argc; i+=2){
+      if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
+      if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
+      if(strcmp(argv[i],"islands")==0) param->islands = max(1, atoi(argv[i+1]));
+      if(strcmp(argv[i],"population")==0) param->population = max(2, atoi(argv[i+1]));
+      if(strcmp(argv[i],"crossover")==0) param->crossover = atoi(argv[i+1]);
+      if(strcmp(argv[i],"migration")==0) param->migration = max(1, atoi(argv[i+1]));
+    }
+  }
+}
+
+/***** malloc with error check ***********************************************/
+void *malloc_e( size_t size ) {
+  void *s;
+  if ( (s=malloc(size)) == NULL ) {
+    fprintf( stderr, "malloc : Not enough memory.\n" );
+    exit( EXIT_FAILURE );
+  }
+  return s;
+}
+
+
+/***** subroutines ***********************************************/
+/***** move jobs off overloaded agents to the cheapest agent with room *****/
+void repair(Evaldata *ev) {
+  const Jobdata *jd = ev->jd;
+  const Joblist *jl = ev->jobs;
+  int *rest_b = ev->rest_b;
+  int j, t;
+
+  for (int i=0; i<jd->m; i++) {
+    for (int k=jl->count[i]-1; k>=0 && rest_b[i]<0; k--) {
+      j = joblist_job(jl, i, k);
+      for (int r=0; r<jd->k; r++) {
+        t = jd->by_cost[j * jd->k + r];
+        if (t != i && jobdata_a(jd, j, t) <= rest_b[t]) {
+          eval_move(ev, j, t);
+          break;
+        }
+      }
+    }
+  }
+}
+
+/***** the better of two random members ************************************/
+int tournament(const int *value, int size, Rng *rng) {
+  int p = rng_int(rng, size);
+  int q = rng_int(rng, size);
+
+  return (value[p] <= value[q]) ? p : q;
+}
+
+/***** a child of pa and pb, with a few random shifts **********************/
+void crossover(int *child, const int *pa, const int *pb, char *mask,
+    Rng *rng, Param *param, GAPdata *gapdata) {
+  uint64_t bits = 0;
+
+  if (param->crossover == 1) {
+    /* the jobs of half of the agents of pa stay together */
+    for (int i=0; i<gapdata->m; i++) {
+      if (i % 64 == 0) bits = rng_next(rng);
+      mask[i] = (bits >> (i % 64)) & 1;
+    }
+    for (int j=0; j<gapdata->n; j++) child[j] = mask[pa[j]] ? pa[j] : pb[j];
+  } else {
+    for (int j=0; j<gapdata->n; j++) {
+      if (j % 64 == 0) bits = rng_next(rng);
+      child[j] = ((bits >> (j % 64)) & 1) ? pa[j] : pb[j];
+    }
+  }
+
+  for (int k=0; k<max(1, (int) (gapdata->n * MUTATION)); k++) {
+    child[rng_int(rng, gapdata->n)] = rng_int(rng, gapdata->m);
+  }
+}
+
+/***** repair sol, then make the best improving shifts; the value of sol ***/
+static int improve(Evaldata *ev, int *sol, int *rest_b, int *weight,
+    Joblist *jl, Movequeue *mq, Archipelago *ar) {
+  eval_init(ev, sol, rest_b, weight, ar->jd, ar->gapdata);
+  eval_jobs(ev, jl);
+  repair(ev);
+  movequeue_descent(mq, ev);
+  if (ev->excess == 0) incumbent_offer(ar->inc, sol, ev->cost);
+  return eval_value(ev);
+}
+
+/***** evolve one island until its thread has used its share of timelim ****/
+void *island(void *arg) {
+  Archipelago *ar = (Archipelago *) arg;
+  GAPdata *gapdata = ar->gapdata;
+  Param *param = ar->param;
+  int k = atomic_fetch_add(&ar->next, 1);
+  Islandslot *slot = &ar->slot[k];
+  int n = gapdata->n, m = gapdata->m, size = param->population;
+  int *arena = (int *) malloc_e((size_t) (size + 1) * n * sizeof(int));
+  int *value = (int *) malloc_e(size * sizeof(int));
+  int *rest_b = (int *) malloc_e(m * sizeof(int));
+  int *weight = (int *) malloc_e(m * sizeof(int));
+  char *mask = (char *) malloc_e(m);
+  int *child = arena + (size_t) size * n;
+  int best, worst, v, cost;
+  bool dup;
+  Evaldata ev;
+  Joblist jl;
+  Movequeue mq;
+  Deadline dl;
+  Rng rng;
+
+#define MEMBER(p) (arena + (size_t) (p) * n)
+
+  for (int i=0; i<m; i++) weight[i] = INFEASIBLE_COST;
+  joblist_init(&jl, m, n);
+  movequeue_init(&mq, ar->jd);
+  /* the islands share timelim, so the process uses about timelim CPU seconds */
+  deadline_init_thread(&dl, param->timelim / (double) param->islands);
+  rng_seed(&rng, param->seed, k + 1);
+
+  for (int p=0; p<size; p++) {
+    rng_fill(&rng, MEMBER(p), n, m);
+    value[p] = improve(&ev, MEMBER(p), rest_b, weight, &jl, &mq, ar);
+  }
+
+  while (!deadline_over(&dl)) {
+    slot->generations++;
+    crossover(child, MEMBER(tournament(value, size, &rng)),
+        MEMBER(tournament(value, size, &rng)), mask, &rng, param, gapdata);
+    v = improve(&ev, child, rest_b, weight, &jl, &mq, ar);
+
+    /* the child replaces the worst member unless it is a copy of one */
+    worst = dup = 0;
+    for (int p=0; p<size; p++) {
+      if (value[p] > value[worst]) worst = p;
+      dup = dup || value[p] == v;
+    }
+    if (!dup && v < value[worst]) {
+      memcpy(MEMBER(worst), child, n * sizeof(int));
+      value[worst] = v;
+    }
+
+    /* send the best member to the next island, and take one in */
+    if (param->islands > 1 && slot->generations % param->migration == 0) {
+      best = 0;
+      for (int p=0; p<size; p++) {
+        if (value[p] < value[best]) best = p;
+      }
+      spsc_push(&ar->ring[k], MEMBER(best), value[best]);
+      if (spsc_pop(&ar->ring[(k + param->islands - 1) % param->islands], child, &cost)) {
+        worst = 0;
+        for (int p=0; p<size; p++) {
+          if (value[p] > value[worst]) worst = p;
+        }
+        if (cost < value[worst]) {
+          memcpy(MEMBER(worst), child, n * sizeof(int));
+          value[worst] = cost;
+          slot->migrants++;
+        }
+      }
+    }
+  }
+#undef MEMBER
+
+  joblist_free(&jl);
+  movequeue_free(&mq);
+  free((void *) arena);
+  free((void *) value);
+  free((void *) rest_b);
+  free((void *) weight);
+  free((void *) mask);
+  return NULL;
+}
+
+/***** main ******************************************************************/
+int main(int argc, char *argv[])
+{
+  Param		param;		/* parameters */
+  GAPdata	gapdata;	/* GAP instance data */
+  Vdata		vdata;		/* various data often needed during search */
+
+  vdata.timebrid = cpu_time();
+  copy_parameters(argc, argv, &param);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
+  prepare_memory(&vdata, &gapdata);
+  if(param.givesol==1){read_sol(&vdata, &gapdata);}
+  vdata.starttime = cpu_time();
+
+  /*
+     Write your program here. Of course you can add your subroutines
+     outside main(). At this point, the instance data is stored in "gapdata".
+     gapdata.n	number of jobs n
+     gapdata.m	number of agents m
+     gapdata.c[i][j]	cost c_{ij} {i, j} = {agent, job} 
+     gapdata.a[i][j]	resource requirement a_{ij} 
+     gapdata.b[i]	available amount b_i of resource at agent i
+     Note that i ranges from 0 to m-1, and j ranges from 0 to n-1. Note also
+     that  you should write, e.g., "gapdata->c[i][j]" in your subroutines.
+     Store your best solution in vdata.bestsol, then "recompute_cost" will
+     compute its cost and its feasibility. The format of vdata.bestsol is:
+     For each job j from 0 to n-1 in this order, the index of the agent 
+     (the value should be given as values from [0, m-1]) to which j is
+     assigned. For example, if n=4 and m=3, and jobs 0, 1, 2 and 3 are
+     assigned to agents 1, 0, 2 and 0, respectively, then vdata.bestsol
+     should be as follows:  
+     vdata.bestsol[0] = 1
+     vdata.bestsol[1] = 0
+     vdata.bestsol[2] = 2
+     vdata.bestsol[3] = 0.
+     Note that you should write "vdata->bestsol[j]" in your subroutines.
+     */
+
+  int islands = param.islands;
+  pthread_t *tid = (pthread_t *) malloc_e(islands * sizeof(pthread_t));
+  long generations = 0;
+  Incumbent inc;
+  Jobdata jd;
+  Archipelago ar;
+  int started;
+
+  jobdata_build(&jd, &gapdata);
+  incumbent_init(&inc, gapdata.n);
+  ar.gapdata = &gapdata;
+  ar.jd = &jd;
+  ar.param = &param;
+  ar.inc = &inc;
+  ar.ring = (Spsc *) aligned_alloc(64, islands * sizeof(Spsc));
+  if (ar.ring == NULL) {
+    fprintf(stderr, "aligned_alloc : Not enough memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  ar.slot = (Islandslot *) aligned_alloc(64, islands * sizeof(Islandslot));
+  if (ar.slot == NULL) {
+    fprintf(stderr, "aligned_alloc : Not enough memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  atomic_init(&ar.next, 0);
+  for (int k=0; k<islands; k++) {
+    spsc_init(&ar.ring[k], RING, gapdata.n);
+    ar.slot[k].generations = ar.slot[k].migrants = 0;
+  }
+
+  for (started=0; started<islands; started++) {
+    if (pthread_create(&tid[started], NULL, island, &ar) != 0) break;
+  }
+  if (started < islands) {
+    fprintf(stderr, "pthread_create : only %d of %d islands.\n", started, islands);
+    exit(EXIT_FAILURE);
+  }
+  for (int k=0; k<started; k++) pthread_join(tid[k], NULL);
+
+  for (int k=0; k<islands; k++) {
+    printf("island %d: %ld generations, %ld migrants taken\n", k,
+        ar.slot[k].generations, ar.slot[k].migrants);
+    generations += ar.slot[k].generations;
+  }
+  printf("generations = %ld (%.0f per CPU second)\n", generations,
+      generations / (double) max(param.timelim, 1));
+  if (incumbent_cost(&inc) < INT_MAX) incumbent_read(&inc, vdata.bestsol);
+
+  vdata.endtime = cpu_time();
+  recompute_cost(&vdata, &gapdata);
+  free_memory(&vdata, &gapdata);
+  for (int k=0; k<islands; k++) spsc_free(&ar.ring[k]);
+  free((void *) ar.ring);
+  free((void *) ar.slot);
+  incumbent_free(&inc);
+  jobdata_free(&jd);
+  free((void *) tid);
+
+  return EXIT_SUCCESS;
+}
@@ -32,15 +32,28 @@ the definition of struct "Param" and mimic the way the default value of
 /***** default values of parameters ******************************************/
 #define	TIMELIM	300	/* the time limit for the algorithm in seconds */
 #define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
+#define	RELINK	1	/* 1: path relinking with the elite pool; 0: none */
+#define	ELITE	10	/* solutions in the elite pool */
+#define	DIVERSITY 0.05	/* the least fraction of jobs between pool members */
+#define	SWEEP	1	/* 1: a round of swaps pairs every job; 0: one random pair */
 
 #define max( a, b ) ( ((a) > (b)) ? (a) : (b) )
 #define min( a, b ) ( ((a) < (b)) ? (a) : (b) )
 
+const int INFEASIBLE_COST = 3;
+
 typedef struct {
   int		timelim;	/* the time limit for the algorithm in secs. */
   int		givesol;	/* give a solution (1) or not (0) */
   /* Never modify the above two lines.  */
   /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
+  int		relink;		/* path relinking with the elite pool */
+  int		elite;		/* solutions in the elite pool */
 } Param;			/* parameters */
 
 typedef struct {
@@ -69,9 +82,16 @@ void read_sol(Vdata *vdata, GAPdata *gapdata);
 void recompute_cost(Vdata *vdata, GAPdata *gapdata);
 void *malloc_e(size_t size);
 
-void greedy_init(int *sol, GAPdata *gapdata);
-int calculate_cost(int *sol, GAPdata *gapdata);
-bool is_feasible(int *rest_b, GAPdata *gapdata);
+#include "jobdata.c"
+#include "joblist.c"
+#include "eval.c"
+#include "gapbin.c"
+#include "rng.c"
+#include "deadline.c"
+#include "elite.c"
+#include "relink.c"
+#include "grasp.c"
+#include "fast_read.c"
 
 /***** check the feasibility and recompute the cost **************************/
 /***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
@@ -138,6 +158,7 @@ void prepare_memory(Vdata *vdata, GAPdata *gapdata)
 void free_memory(Vdata *vdata, GAPdata *gapdata)
 {
   free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
   free((void *) gapdata->c[0]);
   free((void *) gapdata->c);
   free((void *) gapdata->a[0]);
@@ -200,6 +221,11 @@ void copy_parameters(int argc, char *argv[], Param *param)
   /**** copy the parameters ****/
   param->timelim = TIMELIM;
   param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
+  param->relink = RELINK;
+  param->elite = ELITE;
   /**** read the parameters ****/
   if(argc>0 && (argc % 2)==0){
     printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
@@ -208,6 +234,11 @@ void copy_parameters(int argc, char *argv[], Param *param)
     for(i=1; i<argc; i+=2){
       if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
       if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
+      if(strcmp(argv[i],"relink")==0) param->relink = atoi(argv[i+1]);
+      if(strcmp(argv[i],"elite")==0) param->elite = max(2, atoi(argv[i+1]));
     }
   }
 }
@@ -222,61 +253,22 @@ void *malloc_e( size_t size ) {
   return s;
 }
 
-/***** subroutines ***********************************************/
-void greedy_init(int *sol, GAPdata *gapdata) {
-  float sum, rnd;
-  int *vals = (int *) malloc_e(gapdata->m * sizeof(int));
-  int *rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
-  for (int i=0; i<gapdata->m; i++) rest_b[i] = gapdata->b[i];
-
-  for (int j=0; j<gapdata->n; j++) {
-    sum = 0;
-    for (int i=0; i<gapdata->m; i++) {
-      vals[i] = 3 * gapdata->c[i][j] + 2 * gapdata->a[i][j] - min(0, rest_b[i]);
-      sum += ((1.0 / vals[i]) * 2);
-    }
-
-    rnd = (float)rand() / (float)(RAND_MAX/sum);
-    for (int i=0; i<gapdata->m; i++) {
-      rnd -= ((1.0 / vals[i]) * 2);
-      if (rnd < 0) {
-        sol[j] = i;
-        break;
-      }
-    }
-    rest_b[sol[j]] -= gapdata->a[sol[j]][j];
-  }
-
-  free((void *) vals);
-  free((void *) rest_b);
-}
-
-int calculate_cost(int *sol, GAPdata *gapdata) {
-  int cost = 0;
-  for (int i=0; i<gapdata->n; i++) {
-    cost += gapdata->c[sol[i]][i];
-  }
-  return cost;
-}
-
-bool is_feasible(int *rest_b, GAPdata *gapdata) {
-  bool is_f = true;
-  for (int i=0; i<gapdata->m; i++) {
-    if (rest_b[i] < 0) is_f = false;
-  }
-  return is_f;
-}
-
 /***** main ******************************************************************/
 int main(int argc, char *argv[])
 {
   Param		param;		/* parameters */
   GAPdata	gapdata;	/* GAP instance data */
   Vdata		vdata;		/* various data often needed during search */
+  Rng		rng;		/* random number generator of the search */
+  Deadline	dl;		/* the time limit of the search */
 
   vdata.timebrid = cpu_time();
   copy_parameters(argc, argv, &param);
-  read_instance(&gapdata);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
   prepare_memory(&vdata, &gapdata);
   if(param.givesol==1){read_sol(&vdata, &gapdata);}
   vdata.starttime = cpu_time();
@@ -305,93 +297,77 @@ int main(int argc, char *argv[])
      Note that you should write "vdata->bestsol[j]" in your subroutines.
      */
 
-  const int INFEASIBLE_COST = 3;
-
-  int swap, tmp;
-
   int count = 0;
   int pre_val, new_val;
   int best_cost = INT_MAX;
-  int impr;
-  int impr_lim = gapdata.n * 5;
 
   int *new_bestsol = (int *) malloc_e(gapdata.n * sizeof(int));
   int *rest_b = (int *) malloc_e(gapdata.m * sizeof(int));
 
-  int swap_cost, cur_cost;
-
-  while ((cpu_time() - vdata.starttime) < param.timelim) {
+  /* the local optima kept for path relinking */
+  int *guide = (int *) malloc_e(gapdata.n * sizeof(int));
+  int *weight = (int *) malloc_e(gapdata.m * sizeof(int));
+  long relinked = 0;
+  int owner;
+  Jobdata jd;
+  Evaldata ev;
+  Elite elite;
+  Relink rl;
+
+  jobdata_build(&jd, &gapdata);
+  for (int i=0; i<gapdata.m; i++) weight[i] = INFEASIBLE_COST;
+  elite_init(&elite, param.elite, gapdata.n, max(1, (int) (gapdata.n * DIVERSITY)));
+  relink_init(&rl, gapdata.n);
+
+  deadline_init(&dl, vdata.starttime, param.timelim);
+  while (!deadline_over(&dl)) {
     count++;
 
-    srand(count);
-    greedy_init(new_bestsol, &gapdata);
-    pre_val = calculate_cost(new_bestsol, &gapdata);
-    impr = 0;
-
-    for (int i=0; i<gapdata.m; i++) rest_b[i] = gapdata.b[i];
-    for (int i=0; i<gapdata.n; i++) {
-      rest_b[new_bestsol[i]] -= gapdata.a[new_bestsol[i]][i];
-    }
-
-    for (int i=0; i<gapdata.m; i++) {
-      pre_val -= INFEASIBLE_COST * min(0, rest_b[i]);
-    }
-    new_val = pre_val;
+    rng_seed(&rng, param.seed, count);
+    grasp_greedy(new_bestsol, &rng, &gapdata);
+    eval_init(&ev, new_bestsol, rest_b, weight, &jd, &gapdata);
+    pre_val = eval_value(&ev);
 
     printf("INIT: %d\n", pre_val);
 
-    while(impr < impr_lim) {
-      for (int j=0; j<gapdata.n; j++) {
-        swap = rand() % gapdata.n;
-        swap_cost
-          = gapdata.c[new_bestsol[j]][swap]
-          + gapdata.c[new_bestsol[swap]][j]
-          + INFEASIBLE_COST
-          * (max(0, gapdata.a[new_bestsol[j]][swap] - rest_b[new_bestsol[j]])
-              + max(0, gapdata.a[new_bestsol[swap]][j] - rest_b[new_bestsol[swap]]));
-
-        cur_cost
-          = gapdata.c[new_bestsol[j]][j]
-          + gapdata.c[new_bestsol[swap]][swap]
-          + INFEASIBLE_COST
-          * (max(0, gapdata.a[new_bestsol[j]][j] - rest_b[new_bestsol[j]])
-              + max(0, gapdata.a[new_bestsol[swap]][swap] - rest_b[new_bestsol[swap]]));
-
-        if (cur_cost > swap_cost) {
-          tmp = new_bestsol[j];
-
-          rest_b[tmp] += (gapdata.a[tmp][j] - gapdata.a[tmp][swap]);
-          rest_b[new_bestsol[swap]] += (gapdata.a[new_bestsol[swap]][swap] - gapdata.a[new_bestsol[swap]][j]);
-
-          new_bestsol[j] = new_bestsol[swap];
-          new_bestsol[swap] = tmp;
-        }
-      }
-
-      new_val = 0;
-      for (int j=0; j<gapdata.n; j++) {
-        new_val += gapdata.c[new_bestsol[j]][j];
-      }
-      for (int i=0; i<gapdata.m; i++) {
-        new_val -= INFEASIBLE_COST * min(0, rest_b[i]);
-      }
-
-      if (new_val >= pre_val) {
-        impr++;
-      } else {
-        pre_val = new_val;
-        impr = 0;
-      }
-    }
+    new_val = grasp_search(&ev, &rng, SWEEP, gapdata.n * 5);
 
-    if (new_val < best_cost && is_feasible(rest_b, &gapdata)) {
+    if (new_val < best_cost && ev.excess == 0) {
       for (int i=0; i<gapdata.n; i++) {
         vdata.bestsol[i] = new_bestsol[i];
       }
       best_cost = new_val;
+      deadline_best(&dl, best_cost);
     }
 
-    printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, (cpu_time() - vdata.starttime));
+    /* walk from the local optimum to a member of the pool, and search */
+    /* from the best solution on the way */
+    if (param.relink) {
+      if (ev.excess == 0) elite_offer(&elite, new_bestsol, new_val, 0);
+      if (elite_draw(&elite, guide, &owner, &rng) < INT_MAX) {
+        if (relink_run(&rl, &ev, guide) < INT_MAX) {
+          new_val = grasp_search(&ev, &rng, SWEEP, gapdata.n * 5);
+          if (ev.excess == 0) {
+            elite_offer(&elite, new_bestsol, new_val, 0);
+            if (new_val < best_cost) {
+              for (int i=0; i<gapdata.n; i++) {
+                vdata.bestsol[i] = new_bestsol[i];
+              }
+              best_cost = new_val;
+              deadline_best(&dl, best_cost);
+              relinked++;
+            }
+          }
+        }
+      }
+    }
+
+    printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, deadline_elapsed(&dl));
+  }
+
+  if (param.relink) {
+    printf("path relinking: %ld walks, %.1f steps per walk, %ld new bests\n",
+        rl.walks, (double) rl.steps / max(1, rl.walks), relinked);
   }
 
   vdata.endtime = cpu_time();
@@ -399,6 +375,11 @@ int main(int argc, char *argv[])
   free_memory(&vdata, &gapdata);
   free((void *) rest_b);
   free((void *) new_bestsol);
+  free((void *) guide);
+  free((void *) weight);
+  jobdata_free(&jd);
+  elite_free(&elite);
+  relink_free(&rl);
 
   return EXIT_SUCCESS;
 }
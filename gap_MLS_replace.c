@@ -32,12 +32,19 @@ the definition of struct "Param" and mimic the way the default value of
 /***** default values of parameters ******************************************/
 #define	TIMELIM	300	/* the time limit for the algorithm in seconds */
 #define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
+#define	THREADS	1	/* the number of search threads */
 
 typedef struct {
   int		timelim;	/* the time limit for the algorithm in secs. */
   int		givesol;	/* give a solution (1) or not (0) */
   /* Never modify the above two lines.  */
   /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
+  int		threads;	/* run restarts on this many threads if > 1 */
 } Param;			/* parameters */
 
 typedef struct {
@@ -66,8 +73,21 @@ void read_sol(Vdata *vdata, GAPdata *gapdata);
 void recompute_cost(Vdata *vdata, GAPdata *gapdata);
 void *malloc_e(size_t size);
 
-void random_init(int *sol, GAPdata *gapdata);
+#include "gapbin.c"
+#include "rng.c"
+#include "deadline.c"
+#include "incumbent.c"
+#include "multistart.c"
+#include "fast_read.c"
+
+void random_init(int *sol, Rng *rng, GAPdata *gapdata);
 int calculate_cost(int *sol, GAPdata *gapdata);
+int restart(int *sol, int *rest_b, Rng *rng, GAPdata *gapdata);
+void need_order(GAPdata *gapdata);
+
+/* by_need[i*n + r]: the job with the r-th least requirement at agent i; */
+/* built once in main() and only read by the restarts of all threads */
+int *by_need;
 
 /***** check the feasibility and recompute the cost **************************/
 /***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
@@ -134,6 +154,7 @@ void prepare_memory(Vdata *vdata, GAPdata *gapdata)
 void free_memory(Vdata *vdata, GAPdata *gapdata)
 {
   free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
   free((void *) gapdata->c[0]);
   free((void *) gapdata->c);
   free((void *) gapdata->a[0]);
@@ -196,6 +217,10 @@ void copy_parameters(int argc, char *argv[], Param *param)
   /**** copy the parameters ****/
   param->timelim = TIMELIM;
   param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
+  param->threads = THREADS;
   /**** read the parameters ****/
   if(argc>0 && (argc % 2)==0){
     printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
@@ -204,6 +229,10 @@ void copy_parameters(int argc, char *argv[], Param *param)
     for(i=1; i<argc; i+=2){
       if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
       if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
+      if(strcmp(argv[i],"threads")==0) param->threads = atoi(argv[i+1]);
     }
   }
 }
@@ -219,21 +248,21 @@ void *malloc_e( size_t size ) {
 }
 
 /***** subroutines ***********************************************/
-void random_init(int *sol, GAPdata *gapdata) {
+void random_init(int *sol, Rng *rng, GAPdata *gapdata) {
   int swap, tmp;
   bool is_feasible = true;
   int *rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
   for (int i=0; i<gapdata->m; i++) rest_b[i] = gapdata->b[i];
 
   for (int i=0; i<gapdata->n; i++) {
-    sol[i] = rand() % gapdata->m;
+    sol[i] = rng_int(rng, gapdata->m);
 
     rest_b[sol[i]] -= gapdata->a[sol[i]][i];
     if (rest_b[sol[i]] < 0) is_feasible = false;
   }
 
   while (!is_feasible) {
-    swap = rand() % gapdata->m;
+    swap = rng_int(rng, gapdata->m);
     for (int i=0; i<gapdata->n; i++) {
       tmp = sol[i];
       if (rest_b[tmp] > 0) continue;
@@ -262,16 +291,105 @@ int calculate_cost(int *sol, GAPdata *gapdata) {
   return cost;
 }
 
+static const int *need_row;	/* the key of need_cmp() */
+
+static int need_cmp(const void *x, const void *y) {
+  int ax = need_row[*(const int *) x], ay = need_row[*(const int *) y];
+  return (ax > ay) - (ax < ay);
+}
+
+/***** sort the jobs at every agent by their requirement there ***************/
+void need_order(GAPdata *gapdata) {
+  int n = gapdata->n;
+
+  by_need = (int *) malloc_e((size_t) gapdata->m * n * sizeof(int));
+  for (int i=0; i<gapdata->m; i++) {
+    for (int j=0; j<n; j++) by_need[(size_t) i * n + j] = j;
+    need_row = gapdata->a[i];
+    qsort(by_need + (size_t) i * n, n, sizeof(int), need_cmp);
+  }
+}
+
+/***** one restart: random feasible start, then replacements ****************/
+/***** returns the cost of the result, which is always feasible **************/
+int restart(int *sol, int *rest_b, Rng *rng, GAPdata *gapdata) {
+  int n = gapdata->n, m = gapdata->m;
+  int *queue = (int *) malloc_e(n * sizeof(int));
+  char *dirty = (char *) malloc_e(n);
+  int head, tail, queued;
+  int i, j, tmp, best, cost;
+  const int *need;
+
+  random_init(sol, rng, gapdata);
+  cost = calculate_cost(sol, gapdata);
+
+  for (int k=0; k<m; k++) rest_b[k] = gapdata->b[k];
+  for (int j=0; j<n; j++) {
+    rest_b[sol[j]] -= gapdata->a[sol[j]][j];
+  }
+
+  /* only dirty jobs are looked at, and every job is dirty at first; */
+  /* the full ring starts at a random job */
+  for (int j=0; j<n; j++) {
+    queue[j] = j;
+    dirty[j] = 1;
+  }
+  head = tail = rng_int(rng, n);
+  queued = n;
+
+  while (queued > 0) {
+    i = queue[head];
+    head = (head + 1) % n;
+    queued--;
+    dirty[i] = 0;
+
+    tmp = sol[i];
+    best = tmp;
+    for (int k=0; k<m; k++) {
+      if (gapdata->c[k][i] < gapdata->c[best][i] && gapdata->a[k][i] <= rest_b[k]) best = k;
+    }
+    /* clean now: only more room at a cheaper agent can make it improvable */
+    if (best == tmp) continue;
+
+    sol[i] = best;
+    cost += gapdata->c[best][i] - gapdata->c[tmp][i];
+    rest_b[tmp] += gapdata->a[tmp][i];
+    rest_b[best] -= gapdata->a[best][i];
+
+    /* only the slack of tmp grew: wake the jobs that are cheaper there, */
+    /* among those that fit, which come first in by_need */
+    need = by_need + (size_t) tmp * n;
+    for (int r=0; r<n && gapdata->a[tmp][need[r]] <= rest_b[tmp]; r++) {
+      j = need[r];
+      if (dirty[j] || gapdata->c[tmp][j] >= gapdata->c[sol[j]][j]) continue;
+      dirty[j] = 1;
+      queue[tail] = j;
+      tail = (tail + 1) % n;
+      queued++;
+    }
+  }
+
+  free((void *) queue);
+  free((void *) dirty);
+  return cost;
+}
+
 /***** main ******************************************************************/
 int main(int argc, char *argv[])
 {
   Param		param;		/* parameters */
   GAPdata	gapdata;	/* GAP instance data */
   Vdata		vdata;		/* various data often needed during search */
+  Rng		rng;		/* random number generator of the search */
+  Deadline	dl;		/* the time limit of the search */
 
   vdata.timebrid = cpu_time();
   copy_parameters(argc, argv, &param);
-  read_instance(&gapdata);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
   prepare_memory(&vdata, &gapdata);
   if(param.givesol==1){read_sol(&vdata, &gapdata);}
   vdata.starttime = cpu_time();
@@ -300,69 +418,41 @@ int main(int argc, char *argv[])
      Note that you should write "vdata->bestsol[j]" in your subroutines.
      */
 
-  int swap, tmp, rnd_start;
-
   int count = 0;
-  int pre_val, new_val;
+  int new_val;
   int best_cost = INT_MAX;
-  int same;
-  int s, f;
 
   int *new_bestsol = (int *) malloc_e(gapdata.n * sizeof(int));
   int *rest_b = (int *) malloc_e(gapdata.m * sizeof(int));
 
-  while ((cpu_time() - vdata.starttime) < param.timelim) {
-    count++;
-
-    srand(count);
-    random_init(new_bestsol, &gapdata);
-    pre_val = calculate_cost(new_bestsol, &gapdata);
-    same = 0;
+  need_order(&gapdata);
 
-    for (int i=0; i<gapdata.m; i++) rest_b[i] = gapdata.b[i];
-    for (int i=0; i<gapdata.n; i++) {
-      rest_b[new_bestsol[i]] -= gapdata.a[new_bestsol[i]][i];
-    }
+  if (param.threads > 1) {
+    Incumbent inc;
 
-    while(same < 100) {
-      rnd_start = rand() % gapdata.n;
-      swap = rand() % gapdata.m;
-      for (int offset=0; offset<2; offset++) {
-        s = rnd_start - offset*rnd_start;
-        f = gapdata.n - offset*(gapdata.n - rnd_start);
-        for (int i=s; i<f; i++) {
-          tmp = new_bestsol[i];
-          if (gapdata.c[tmp][i] < gapdata.c[swap][i]) continue;
-          if (rest_b[swap] - gapdata.a[swap][i] >= 0) {
-            new_bestsol[i] = swap;
-
-            rest_b[tmp] += gapdata.a[tmp][i];
-            rest_b[swap] -= gapdata.a[swap][i];
-          }
-        }
-      }
+    incumbent_init(&inc, gapdata.n);
+    multistart_run(param.threads, restart, param.seed, param.timelim,
+        &inc, &gapdata);
+    if (incumbent_cost(&inc) < INT_MAX) incumbent_read(&inc, vdata.bestsol);
+    incumbent_free(&inc);
+  } else {
+    deadline_init(&dl, vdata.starttime, param.timelim);
+    while (!deadline_over(&dl)) {
+      count++;
 
-      new_val = 0;
-      for (int i=0; i<gapdata.n; i++) {
-        new_val += gapdata.c[new_bestsol[i]][i];
-      }
+      rng_seed(&rng, param.seed, count);
+      new_val = restart(new_bestsol, rest_b, &rng, &gapdata);
 
-      if (new_val == pre_val) {
-        same++;
-      } else {
-        pre_val = new_val;
-        same = 0;
+      if (new_val < best_cost) {
+        for (int i=0; i<gapdata.n; i++) {
+          vdata.bestsol[i] = new_bestsol[i];
+        }
+        best_cost = new_val;
+        deadline_best(&dl, best_cost);
       }
-    }
 
-    if (new_val < best_cost) {
-      for (int i=0; i<gapdata.n; i++) {
-        vdata.bestsol[i] = new_bestsol[i];
-      }
-      best_cost = new_val;
+      printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, deadline_elapsed(&dl));
     }
-
-    printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, (cpu_time() - vdata.starttime));
   }
 
   vdata.endtime = cpu_time();
@@ -370,6 +460,7 @@ int main(int argc, char *argv[])
   free_memory(&vdata, &gapdata);
   free((void *) rest_b);
   free((void *) new_bestsol);
+  free((void *) by_need);
 
   return EXIT_SUCCESS;
 }
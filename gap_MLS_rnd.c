@@ -32,17 +32,28 @@ the definition of struct "Param" and mimic the way the default value of
 /***** default values of parameters ******************************************/
 #define	TIMELIM	300	/* the time limit for the algorithm in seconds */
 #define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
+#define	THREADS	1	/* the number of search threads */
 
 #define max( a, b ) ( ((a) > (b)) ? (a) : (b) )
 #define min( a, b ) ( ((a) < (b)) ? (a) : (b) )
 
 const int INFEASIBLE_COST = 20;
 
+/* the INIT line of every restart; only in the sequential mode, since the */
+/* lines of several threads would interleave */
+bool print_init = true;
+
 typedef struct {
   int		timelim;	/* the time limit for the algorithm in secs. */
   int		givesol;	/* give a solution (1) or not (0) */
   /* Never modify the above two lines.  */
   /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
+  int		threads;	/* run restarts on this many threads if > 1 */
 } Param;			/* parameters */
 
 typedef struct {
@@ -71,9 +82,17 @@ void read_sol(Vdata *vdata, GAPdata *gapdata);
 void recompute_cost(Vdata *vdata, GAPdata *gapdata);
 void *malloc_e(size_t size);
 
-void random_init(int *sol, GAPdata *gapdata);
-bool neighbour(int *sol, GAPdata *gapdata, int *rest_b, int rp);
+#include "gapbin.c"
+#include "rng.c"
+#include "deadline.c"
+#include "incumbent.c"
+#include "multistart.c"
+#include "fast_read.c"
+
+void random_init(int *sol, Rng *rng, GAPdata *gapdata);
+bool neighbour(int *sol, Rng *rng, GAPdata *gapdata, int *rest_b, int rp);
 int calculate_cost(int *sol, GAPdata *gapdata);
+int restart(int *sol, int *rest_b, Rng *rng, GAPdata *gapdata);
 bool is_feasible(int *rest_b, GAPdata *gapdata);
 
 /***** check the feasibility and recompute the cost **************************/
@@ -141,6 +160,7 @@ void prepare_memory(Vdata *vdata, GAPdata *gapdata)
 void free_memory(Vdata *vdata, GAPdata *gapdata)
 {
   free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
   free((void *) gapdata->c[0]);
   free((void *) gapdata->c);
   free((void *) gapdata->a[0]);
@@ -203,6 +223,10 @@ void copy_parameters(int argc, char *argv[], Param *param)
   /**** copy the parameters ****/
   param->timelim = TIMELIM;
   param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
+  param->threads = THREADS;
   /**** read the parameters ****/
   if(argc>0 && (argc % 2)==0){
     printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
@@ -211,6 +235,10 @@ void copy_parameters(int argc, char *argv[], Param *param)
     for(i=1; i<argc; i+=2){
       if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
       if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
+      if(strcmp(argv[i],"threads")==0) param->threads = atoi(argv[i+1]);
     }
   }
 }
@@ -226,18 +254,16 @@ void *malloc_e( size_t size ) {
 }
 
 /***** subroutines ***********************************************/
-void random_init(int *sol, GAPdata *gapdata) {
-  for (int i=0; i<gapdata->n; i++) {
-    sol[i] = rand() % gapdata->m;
-  }
+void random_init(int *sol, Rng *rng, GAPdata *gapdata) {
+  rng_fill(rng, sol, gapdata->n, gapdata->m);
 }
 
-bool neighbour(int *sol, GAPdata *gapdata, int *rest_b, int rp) {
+bool neighbour(int *sol, Rng *rng, GAPdata *gapdata, int *rest_b, int rp) {
   int a, b, tmp, swap_cost, cur_cost;
   bool is_swap = false;
   for (int k=0; k<rp; k++) {
-    a = rand() % gapdata->n;
-    b = rand() % gapdata->n;
+    a = rng_int(rng, gapdata->n);
+    b = rng_int(rng, gapdata->n);
     if (a == b) continue;
     swap_cost
       = gapdata->c[sol[b]][a]
@@ -284,16 +310,68 @@ bool is_feasible(int *rest_b, GAPdata *gapdata) {
   return is_f;
 }
 
+/***** one restart: random start, then random swaps *************************/
+/***** returns the cost if the result is feasible, INT_MAX otherwise *********/
+int restart(int *sol, int *rest_b, Rng *rng, GAPdata *gapdata) {
+  int pre_val, new_val;
+  int impr = 0;
+  int impr_lim = gapdata->n * 5;
+  bool is_swap = false;
+
+  random_init(sol, rng, gapdata);
+  pre_val = calculate_cost(sol, gapdata);
+
+  for (int i=0; i<gapdata->m; i++) rest_b[i] = gapdata->b[i];
+  for (int i=0; i<gapdata->n; i++) {
+    rest_b[sol[i]] -= gapdata->a[sol[i]][i];
+  }
+
+  for (int i=0; i<gapdata->m; i++) {
+    pre_val -= INFEASIBLE_COST * min(0, rest_b[i]);
+  }
+  new_val = pre_val;
+
+  if (print_init) printf("INIT: %d\n", pre_val);
+
+  while(impr < impr_lim) {
+    is_swap = neighbour(sol, rng, gapdata, rest_b, 1);
+    if (is_swap) {
+      new_val = 0;
+      for (int j=0; j<gapdata->n; j++) {
+        new_val += gapdata->c[sol[j]][j];
+      }
+      for (int i=0; i<gapdata->m; i++) {
+        new_val -= INFEASIBLE_COST * min(0, rest_b[i]);
+      }
+    }
+
+    if (new_val >= pre_val) {
+      impr++;
+    } else {
+      pre_val = new_val;
+      impr = 0;
+    }
+  }
+
+  return is_feasible(rest_b, gapdata) ? new_val : INT_MAX;
+}
+
 /***** main ******************************************************************/
 int main(int argc, char *argv[])
 {
   Param		param;		/* parameters */
   GAPdata	gapdata;	/* GAP instance data */
   Vdata		vdata;		/* various data often needed during search */
+  Rng		rng;		/* random number generator of the search */
+  Deadline	dl;		/* the time limit of the search */
 
   vdata.timebrid = cpu_time();
   copy_parameters(argc, argv, &param);
-  read_instance(&gapdata);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
   prepare_memory(&vdata, &gapdata);
   if(param.givesol==1){read_sol(&vdata, &gapdata);}
   vdata.starttime = cpu_time();
@@ -322,71 +400,40 @@ int main(int argc, char *argv[])
      Note that you should write "vdata->bestsol[j]" in your subroutines.
      */
 
-
-  // int a, b, tmp;
-
   int count = 0;
-  int pre_val, new_val;
+  int new_val;
   int best_cost = INT_MAX;
-  int impr;
-  int impr_lim = gapdata.n * 5;
 
   int *new_bestsol = (int *) malloc_e(gapdata.n * sizeof(int));
   int *rest_b = (int *) malloc_e(gapdata.m * sizeof(int));
 
-  // int swap_cost, cur_cost;
-  bool is_swap = false;
-
-  int t = 0;
-
-  while ((cpu_time() - vdata.starttime) < param.timelim) {
-    count++;
-    srand(count);
-
-    random_init(new_bestsol, &gapdata);
-    pre_val = calculate_cost(new_bestsol, &gapdata);
-    impr = 0;
-
-    for (int i=0; i<gapdata.m; i++) rest_b[i] = gapdata.b[i];
-    for (int i=0; i<gapdata.n; i++) {
-      rest_b[new_bestsol[i]] -= gapdata.a[new_bestsol[i]][i];
-    }
-
-    for (int i=0; i<gapdata.m; i++) {
-      pre_val -= INFEASIBLE_COST * min(0, rest_b[i]);
-    }
-    new_val = pre_val;
-
-    printf("INIT: %d\n", pre_val);
-
-    while(impr < impr_lim) {
-      is_swap = neighbour(new_bestsol, &gapdata, rest_b, 1);
-      if (is_swap) {
-        new_val = 0;
-        for (int j=0; j<gapdata.n; j++) {
-          new_val += gapdata.c[new_bestsol[j]][j];
-        }
-        for (int i=0; i<gapdata.m; i++) {
-          new_val -= INFEASIBLE_COST * min(0, rest_b[i]);
+  if (param.threads > 1) {
+    Incumbent inc;
+
+    print_init = false;
+    incumbent_init(&inc, gapdata.n);
+    multistart_run(param.threads, restart, param.seed, param.timelim,
+        &inc, &gapdata);
+    if (incumbent_cost(&inc) < INT_MAX) incumbent_read(&inc, vdata.bestsol);
+    incumbent_free(&inc);
+  } else {
+    deadline_init(&dl, vdata.starttime, param.timelim);
+    while (!deadline_over(&dl)) {
+      count++;
+
+      rng_seed(&rng, param.seed, count);
+      new_val = restart(new_bestsol, rest_b, &rng, &gapdata);
+
+      if (new_val < best_cost) {
+        for (int i=0; i<gapdata.n; i++) {
+          vdata.bestsol[i] = new_bestsol[i];
         }
+        best_cost = new_val;
+        deadline_best(&dl, best_cost);
       }
 
-      if (new_val >= pre_val) {
-        impr++;
-      } else {
-        pre_val = new_val;
-        impr = 0;
-      }
+      printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, deadline_elapsed(&dl));
     }
-
-    if (new_val < best_cost && is_feasible(rest_b, &gapdata)) {
-      for (int i=0; i<gapdata.n; i++) {
-        vdata.bestsol[i] = new_bestsol[i];
-      }
-      best_cost = new_val;
-    }
-
-    printf("DONE Step: %d Cost: %d Time: %f\n", count, best_cost, (cpu_time() - vdata.starttime));
   }
 
   vdata.endtime = cpu_time();
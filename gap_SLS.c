@@ -32,12 +32,17 @@ the definition of struct "Param" and mimic the way the default value of
 /***** default values of parameters ******************************************/
 #define	TIMELIM	300	/* the time limit for the algorithm in seconds */
 #define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
 
 typedef struct {
   int		timelim;	/* the time limit for the algorithm in secs. */
   int		givesol;	/* give a solution (1) or not (0) */
   /* Never modify the above two lines.  */
   /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
 } Param;			/* parameters */
 
 typedef struct {
@@ -66,7 +71,12 @@ void read_sol(Vdata *vdata, GAPdata *gapdata);
 void recompute_cost(Vdata *vdata, GAPdata *gapdata);
 void *malloc_e(size_t size);
 
-void random_init(Vdata *vdata, GAPdata *gapdata);
+#include "gapbin.c"
+#include "rng.c"
+#include "deadline.c"
+#include "fast_read.c"
+
+void random_init(Vdata *vdata, Rng *rng, GAPdata *gapdata);
 int calculate_cost(Vdata *vdata, GAPdata *gapdata);
 
 /***** check the feasibility and recompute the cost **************************/
@@ -134,6 +144,7 @@ void prepare_memory(Vdata *vdata, GAPdata *gapdata)
 void free_memory(Vdata *vdata, GAPdata *gapdata)
 {
   free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
   free((void *) gapdata->c[0]);
   free((void *) gapdata->c);
   free((void *) gapdata->a[0]);
@@ -196,6 +207,9 @@ void copy_parameters(int argc, char *argv[], Param *param)
   /**** copy the parameters ****/
   param->timelim = TIMELIM;
   param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
   /**** read the parameters ****/
   if(argc>0 && (argc % 2)==0){
     printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
@@ -204,6 +218,9 @@ void copy_parameters(int argc, char *argv[], Param *param)
     for(i=1; i<argc; i+=2){
       if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
       if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
     }
   }
 }
@@ -219,21 +236,21 @@ void *malloc_e( size_t size ) {
 }
 
 /***** subroutines ***********************************************/
-void random_init(Vdata *vdata, GAPdata *gapdata) {
+void random_init(Vdata *vdata, Rng *rng, GAPdata *gapdata) {
   int swap, tmp;
   bool is_feasible = true;
   int *rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
   for (int i=0; i<gapdata->m; i++) rest_b[i] = gapdata->b[i];
 
   for (int i=0; i<gapdata->n; i++) {
-    vdata->bestsol[i] = rand() % gapdata->m;
+    vdata->bestsol[i] = rng_int(rng, gapdata->m);
 
     rest_b[vdata->bestsol[i]] -= gapdata->a[vdata->bestsol[i]][i];
     if (rest_b[vdata->bestsol[i]] < 0) is_feasible = false;
   }
 
   while (!is_feasible) {
-    swap = rand() % gapdata->m;
+    swap = rng_int(rng, gapdata->m);
     for (int i=0; i<gapdata->n; i++) {
       tmp = vdata->bestsol[i];
       if (rest_b[tmp] > 0) continue;
@@ -268,10 +285,16 @@ int main(int argc, char *argv[])
   Param		param;		/* parameters */
   GAPdata	gapdata;	/* GAP instance data */
   Vdata		vdata;		/* various data often needed during search */
+  Rng		rng;		/* random number generator of the search */
+  Deadline	dl;		/* the time limit of the search */
 
   vdata.timebrid = cpu_time();
   copy_parameters(argc, argv, &param);
-  read_instance(&gapdata);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
   prepare_memory(&vdata, &gapdata);
   if(param.givesol==1){read_sol(&vdata, &gapdata);}
   vdata.starttime = cpu_time();
@@ -304,8 +327,8 @@ int main(int argc, char *argv[])
   // bool is_feasible = greedy(&vdata, &gapdata);
   // printf("Is feasible: %d\n", is_feasible);
 
-  srand((unsigned) time(NULL));
-  random_init(&vdata, &gapdata);
+  rng_seed(&rng, param.seed, 0);
+  random_init(&vdata, &rng, &gapdata);
 
   int current_cost = calculate_cost(&vdata, &gapdata);
   printf("Initial cost: %d\n", current_cost);
@@ -320,9 +343,11 @@ int main(int argc, char *argv[])
   int s, f;
   int pre_val = calculate_cost(&vdata, &gapdata);
   int new_val, same = 0;
-  while ((cpu_time() - vdata.starttime) < param.timelim && same < 100) {
-    rnd_start = rand() % gapdata.n;
-    swap = rand() % gapdata.m;
+  bool feasible;
+  deadline_init(&dl, vdata.starttime, param.timelim);
+  while (!deadline_over(&dl) && same < 100) {
+    rnd_start = rng_int(&rng, gapdata.n);
+    swap = rng_int(&rng, gapdata.m);
     for (int offset=0; offset<2; offset++) {
       s = rnd_start - offset*rnd_start;
       f = gapdata.n - offset*(gapdata.n - rnd_start);
@@ -345,6 +370,9 @@ int main(int argc, char *argv[])
     } else {
       pre_val = new_val;
       same = 0;
+      feasible = true;
+      for (int i=0; i<gapdata.m; i++) feasible = feasible && rest_b[i] >= 0;
+      if (feasible) deadline_best(&dl, new_val);
     }
     printf("Cost: %d\n", new_val);
   }
@@ -0,0 +1,447 @@
+/******************************************************************************
+  A template program for developing a GAP solver. Subroutines to read instance
+  data and compute the cost of a given solution are included.
+
+  This program can also be used to compute the cost and check the feasibility
+  of a solution given from a file. The format of a file is:
+  for each job j from 1 to n in this order, the index of the agent (the value
+  should be given as values from [1, m]) to which j is assigned. For example,
+  if n=4 and m=3, and jobs 1, 2, 3 and 4 are assigned to agents 2, 1, 3 and 1,
+  respectively, then the data in the file should be as follows:  2 1 3 1.
+
+NOTE: Index i of agents ranges from 0 to m-1, and
+index j of jobs   ranges from 0 to n-1 in the program,
+while in the solution file,
+index i of agents ranges from 1 to m, and
+index j of jobs   ranges from 1 to n in the program.
+Sorry for the confusion.
+
+If you would like to use various parameters, it might be useful to modify
+the definition of struct "Param" and mimic the way the default value of
+"timelim" is given and how its value is input from the command line.
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include "cpu_time.c"
+
+/***** default values of parameters ******************************************/
+#define	TIMELIM	300	/* the time limit for the algorithm in seconds */
+#define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
+#define	ADAPTIVE 1	/* 1: adapt the penalty weights; 0: INFEASIBLE_COST */
+#define	LAGRANGE 300	/* subgradient iterations for the lower bound; 0: none */
+#define	TENURE	10	/* the shortest tabu tenure */
+#define	CANDIDATES 10	/* jobs whose swaps are evaluated in every step */
+
+#define max( a, b ) ( ((a) > (b)) ? (a) : (b) )
+#define min( a, b ) ( ((a) < (b)) ? (a) : (b) )
+
+const int INFEASIBLE_COST = 20;
+
+typedef struct {
+  int		timelim;	/* the time limit for the algorithm in secs. */
+  int		givesol;	/* give a solution (1) or not (0) */
+  /* Never modify the above two lines.  */
+  /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
+  int		adaptive;	/* adapt the penalty weights per agent */
+  int		lagrange;	/* subgradient iterations for the lower bound */
+  int		tenure;		/* the shortest tabu tenure */
+  int		candidates;	/* jobs whose swaps are evaluated in every step */
+} Param;			/* parameters */
+
+typedef struct {
+  int	n;	/* number of jobs */
+  int	m;	/* number of agents */
+  int	**c;	/* cost matrix c_{ij} */
+  int	**a;	/* resource requirement matrix a_{ij} */
+  int	*b;	/* available amount b_i of resource for each agent i */
+} GAPdata;	/* data of the generalized assignment problem */
+
+typedef struct {
+  double	timebrid;	/* the time before reading the instance data */
+  double	starttime;	/* the time the search started */
+  double	endtime;	/* the time the search ended */
+  int		*bestsol;	/* the best solution found so far */
+  /* Never modify the above four lines. */
+  /* You can add more components below. */
+} Vdata;		/* various data often necessary during the search */
+
+/*************************** functions ***************************************/
+void copy_parameters(int argc, char *arcv[], Param *param);
+void read_instance(GAPdata *gapdata);
+void prepare_memory(Vdata *vdata, GAPdata *gapdata);
+void free_memory(Vdata *vdata, GAPdata *gapdata);
+void read_sol(Vdata *vdata, GAPdata *gapdata);
+void recompute_cost(Vdata *vdata, GAPdata *gapdata);
+void *malloc_e(size_t size);
+
+#include "jobdata.c"
+#include "joblist.c"
+#include "eval.c"
+#include "penalty.c"
+#include "gapbin.c"
+#include "rng.c"
+#include "deadline.c"
+#include "lagrange.c"
+#include "fast_read.c"
+
+bool tabu_step(Evaldata *ev, Rng *rng, long *tabu, long iter, int best,
+    Param *param, GAPdata *gapdata);
+
+/***** check the feasibility and recompute the cost **************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void recompute_cost(Vdata *vdata, GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	*rest_b;	/* the amount of resource available at each agent */
+  int	cost, penal;	/* the cost; the penalty = the total capacity excess */
+  int	temp;		/* temporary variable */
+
+  rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  cost = penal = 0;
+  for(i=0; i<gapdata->m; i++){rest_b[i] = gapdata->b[i];}
+  for(j=0; j<gapdata->n; j++){
+    rest_b[vdata->bestsol[j]] -= gapdata->a[vdata->bestsol[j]][j];
+    cost += gapdata->c[vdata->bestsol[j]][j];
+  }
+  for(i=0; i<gapdata->m; i++){
+    temp = rest_b[i];
+    if(temp<0){penal -= temp;}
+  }
+  printf("recomputed cost = %d\n", cost);
+  if(penal>0){
+    printf("INFEASIBLE!!\n");
+    printf(" resource left:");
+    for(i=0; i<gapdata->m; i++){printf(" %3d", rest_b[i]);}
+    printf("\n");
+  }
+  printf("time for the search:       %7.2f seconds\n",
+      vdata->endtime - vdata->starttime);
+  printf("time to read the instance: %7.2f seconds\n",
+      vdata->starttime - vdata->timebrid);
+
+  free((void *) rest_b);
+}
+
+/***** read a solution from STDIN ********************************************/
+void read_sol(Vdata *vdata, GAPdata *gapdata)
+{
+  int	j;		/* index of jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  for(j=0; j<gapdata->n; j++){
+    fscanf(fp, "%d", &value_read);
+    /* change the range of agents from [1, m] to [0, m-1] */
+    vdata->bestsol[j] = value_read - 1;
+  }
+}
+
+/***** prepare memory space **************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void prepare_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  int j;
+
+  vdata->bestsol = (int *)  malloc_e(gapdata->n * sizeof(int));
+  /* the next line is just to avoid confusion */
+  for(j=0; j<gapdata->n; j++){vdata->bestsol[j] = 0;}
+}
+
+/***** free memory space *****************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void free_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
+  free((void *) gapdata->c[0]);
+  free((void *) gapdata->c);
+  free((void *) gapdata->a[0]);
+  free((void *) gapdata->a);
+  free((void *) gapdata->b);
+}
+
+/***** read the instance data ************************************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void read_instance(GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  /* read the number of agents and jobs */
+  fscanf(fp, "%d", &value_read);	/* number of agents */
+  gapdata->m = value_read;
+  fscanf(fp,"%d",&value_read);		/* number of jobs */
+  gapdata->n = value_read;
+
+  /* initialize memory */
+  gapdata->c    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->c[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->c[i] = gapdata->c[i-1] + gapdata->n;}
+  gapdata->a    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->a[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->a[i] = gapdata->a[i-1] + gapdata->n;}
+  gapdata->b    = (int *)  malloc_e(gapdata->m * sizeof(int));
+
+  /* read the cost coefficients */   
+  for(i=0; i<gapdata->m; i++){    
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->c[i][j] = value_read;
+    }
+  }
+
+  /* read the resource consumption */
+  for(i=0; i<gapdata->m; i++){
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->a[i][j] = value_read;
+    }
+  }
+
+  /* read the resource capacity */
+  for(i=0; i<gapdata->m; i++){    
+    fscanf(fp,"%d", &value_read);
+    gapdata->b[i] = value_read;
+  }
+}
+
+/***** copy and read the parameters ******************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void copy_parameters(int argc, char *argv[], Param *param)
+{
+  int i;
+
+  /**** copy the parameters ****/
+  param->timelim = TIMELIM;
+  param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
+  param->adaptive = ADAPTIVE;
+  param->lagrange = LAGRANGE;
+  param->tenure = TENURE;
+  param->candidates = CANDIDATES;
+  /**** read the parameters ****/
+  if(argc>0 && (argc % 2)==0){
+    printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
+    exit(EXIT_FAILURE);}
+  else{
+    for(i=1; i<argc; i+=2){
+      if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
+      if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
+      if(strcmp(argv[i],"adaptive")==0) param->adaptive = atoi(argv[i+1]);
+      if(strcmp(argv[i],"lagrange")==0) param->lagrange = atoi(argv[i+1]);
+      if(strcmp(argv[i],"tenure")==0) param->tenure = atoi(argv[i+1]);
+      if(strcmp(argv[i],"candidates")==0) param->candidates = atoi(argv[i+1]);
+    }
+  }
+}
+
+/***** malloc with error check ***********************************************/
+void *malloc_e( size_t size ) {
+  void *s;
+  if ( (s=malloc(size)) == NULL ) {
+    fprintf( stderr, "malloc : Not enough memory.\n" );
+    exit( EXIT_FAILURE );
+  }
+  return s;
+}
+
+
+/***** subroutines ***********************************************/
+/***** make the best admissible shift or swap; false if none is admissible ***/
+bool tabu_step(Evaldata *ev, Rng *rng, long *tabu, long iter, int best,
+    Param *param, GAPdata *gapdata) {
+  const Jobdata *jd = ev->jd;
+  const Joblist *jl = ev->jobs;
+  int m = gapdata->m, n = gapdata->n;
+  int *sol = ev->sol;
+  int bj1 = -1, bj2 = -1, bi = -1, bvalue = INT_MAX, ties = 0;
+  int i, j1, j2, i1, i2;
+  bool aspire;
+  Evaldelta dt;
+
+  /* a tabu move is admissible if it gives a new best feasible solution */
+#define TABU_CONSIDER(tabu_move, j, j2, i) \
+  aspire = (ev->excess + dt.excess == 0 && ev->cost + dt.cost < best); \
+  if ((!(tabu_move) || aspire) && dt.value <= bvalue) { \
+    if (dt.value < bvalue) ties = 0; \
+    if (rng_int(rng, ++ties) == 0) { \
+      bvalue = dt.value; bj1 = (j); bj2 = (j2); bi = (i); \
+    } \
+  }
+
+  /* every job only goes to its candidate agents (jobdata.c): O(n k) */
+  for (int j=0; j<n; j++) {
+    for (int r=0; r<jd->k; r++) {
+      i = jd->by_ratio[j * jd->k + r];
+      if (i == sol[j]) continue;
+      dt = eval_move_delta(ev, j, i);
+      TABU_CONSIDER(tabu[(size_t) j*m + i] > iter, j, -1, i);
+    }
+  }
+
+  /* swaps only for a few jobs, with the jobs at their candidate agents */
+  for (int k=0; k<param->candidates; k++) {
+    j1 = rng_int(rng, n);
+    i1 = sol[j1];
+    for (int r=0; r<jd->k; r++) {
+      i2 = jd->by_ratio[j1 * jd->k + r];
+      if (i2 == i1) continue;
+      for (int q=0; q<jl->count[i2]; q++) {
+        j2 = joblist_job(jl, i2, q);
+        dt = eval_swap_delta(ev, j1, j2);
+        TABU_CONSIDER(tabu[(size_t) j1*m + i2] > iter || tabu[(size_t) j2*m + i1] > iter,
+            j1, j2, i2);
+      }
+    }
+  }
+#undef TABU_CONSIDER
+
+  if (bj1 < 0) return false;
+
+  /* moving a job back to the agent it leaves is tabu for a while */
+  tabu[(size_t) bj1*m + sol[bj1]] = iter + param->tenure + rng_int(rng, param->tenure + 1);
+  if (bj2 < 0) {
+    eval_move(ev, bj1, bi);
+  } else {
+    tabu[(size_t) bj2*m + sol[bj2]] = iter + param->tenure + rng_int(rng, param->tenure + 1);
+    eval_swap(ev, bj1, bj2);
+  }
+  return true;
+}
+
+/***** main ******************************************************************/
+int main(int argc, char *argv[])
+{
+  Param		param;		/* parameters */
+  GAPdata	gapdata;	/* GAP instance data */
+  Vdata		vdata;		/* various data often needed during search */
+  Rng		rng;		/* random number generator of the search */
+  Deadline	dl;		/* the time limit of the search */
+
+  vdata.timebrid = cpu_time();
+  copy_parameters(argc, argv, &param);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
+  prepare_memory(&vdata, &gapdata);
+  if(param.givesol==1){read_sol(&vdata, &gapdata);}
+  vdata.starttime = cpu_time();
+
+  /*
+     Write your program here. Of course you can add your subroutines
+     outside main(). At this point, the instance data is stored in "gapdata".
+     gapdata.n	number of jobs n
+     gapdata.m	number of agents m
+     gapdata.c[i][j]	cost c_{ij} {i, j} = {agent, job} 
+     gapdata.a[i][j]	resource requirement a_{ij} 
+     gapdata.b[i]	available amount b_i of resource at agent i
+     Note that i ranges from 0 to m-1, and j ranges from 0 to n-1. Note also
+     that  you should write, e.g., "gapdata->c[i][j]" in your subroutines.
+     Store your best solution in vdata.bestsol, then "recompute_cost" will
+     compute its cost and its feasibility. The format of vdata.bestsol is:
+     For each job j from 0 to n-1 in this order, the index of the agent 
+     (the value should be given as values from [0, m-1]) to which j is
+     assigned. For example, if n=4 and m=3, and jobs 0, 1, 2 and 3 are
+     assigned to agents 1, 0, 2 and 0, respectively, then vdata.bestsol
+     should be as follows:  
+     vdata.bestsol[0] = 1
+     vdata.bestsol[1] = 0
+     vdata.bestsol[2] = 2
+     vdata.bestsol[3] = 0.
+     Note that you should write "vdata->bestsol[j]" in your subroutines.
+     */
+
+  long iter = 0;
+  int best_cost = INT_MAX;
+
+  int *sol = (int *) malloc_e(gapdata.n * sizeof(int));
+  int *rest_b = (int *) malloc_e(gapdata.m * sizeof(int));
+  long *tabu = (long *) malloc_e((size_t) gapdata.n * gapdata.m * sizeof(long));
+  Jobdata jd;
+  Joblist jl;
+  Evaldata ev;
+  Penalty pen;
+  Lagrange lg;
+  int bound = INT_MIN;
+
+  jobdata_build(&jd, &gapdata);
+  joblist_init(&jl, gapdata.m, gapdata.n);
+  if (param.adaptive) {
+    penalty_init(&pen, gapdata.m, INFEASIBLE_COST, 1, 100 * INFEASIBLE_COST);
+  } else {
+    penalty_init(&pen, gapdata.m, INFEASIBLE_COST, INFEASIBLE_COST, INFEASIBLE_COST);
+  }
+  for (int k=0; k<gapdata.n * gapdata.m; k++) tabu[k] = 0;
+
+  deadline_init(&dl, vdata.starttime, param.timelim);
+  if (param.lagrange > 0) {
+    lagrange_init(&lg, &gapdata);
+    bound = lagrange_start(&lg, &gapdata, param.lagrange, &dl);
+    printf("lower bound = %d (%d iterations)\n", bound, lg.iter);
+  }
+
+  rng_seed(&rng, param.seed, 0);
+  jobdata_greedy(&jd, gapdata.b, sol);
+  eval_init(&ev, sol, rest_b, pen.weight, &jd, &gapdata);
+  eval_jobs(&ev, &jl);
+
+  while (!deadline_over(&dl) && best_cost > bound) {
+    iter++;
+    tabu_step(&ev, &rng, tabu, iter, best_cost, &param, &gapdata);
+
+    if (ev.excess == 0 && ev.cost < best_cost) {
+      best_cost = ev.cost;
+      for (int j=0; j<gapdata.n; j++) {
+        vdata.bestsol[j] = sol[j];
+      }
+      deadline_best(&dl, best_cost);
+      /* a real upper bound makes the subgradient steps much better;
+         lagrange_update() returns at once unless a few steps are due */
+      if (param.lagrange > 0) {
+        bound = lagrange_update(&lg, &gapdata, best_cost, &dl);
+      }
+    }
+
+    if (iter % gapdata.n == 0) {
+      /* oscillate around the boundary of the feasible region */
+      penalty_update(&pen, &ev, gapdata.m);
+    }
+  }
+
+  printf("iterations = %ld (%.0f per second)\n", iter,
+      iter / max(deadline_elapsed(&dl), 1e-9));
+  if (param.lagrange > 0) {
+    printf("lower bound = %d (%d iterations)\n", bound, lg.iter);
+    lagrange_free(&lg);
+  }
+
+  vdata.endtime = cpu_time();
+  recompute_cost(&vdata, &gapdata);
+  free_memory(&vdata, &gapdata);
+  jobdata_free(&jd);
+  joblist_free(&jl);
+  penalty_free(&pen);
+  free((void *) tabu);
+  free((void *) rest_b);
+  free((void *) sol);
+
+  return EXIT_SUCCESS;
+}
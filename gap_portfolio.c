@@ -0,0 +1,538 @@
+/******************************************************************************
+  A template program for developing a GAP solver. Subroutines to read instance
+  data and compute the cost of a given solution are included.
+
+  This program can also be used to compute the cost and check the feasibility
+  of a solution given from a file. The format of a file is:
+  for each job j from 1 to n in this order, the index of the agent (the value
+  should be given as values from [1, m]) to which j is assigned. For example,
+  if n=4 and m=3, and jobs 1, 2, 3 and 4 are assigned to agents 2, 1, 3 and 1,
+  respectively, then the data in the file should be as follows:  2 1 3 1.
+
+NOTE: Index i of agents ranges from 0 to m-1, and
+index j of jobs   ranges from 0 to n-1 in the program,
+while in the solution file,
+index i of agents ranges from 1 to m, and
+index j of jobs   ranges from 1 to n in the program.
+Sorry for the confusion.
+
+If you would like to use various parameters, it might be useful to modify
+the definition of struct "Param" and mimic the way the default value of
+"timelim" is given and how its value is input from the command line.
+ ******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include "cpu_time.c"
+
+/***** default values of parameters ******************************************/
+#define	TIMELIM	300	/* the time limit for the algorithm in seconds */
+#define	GIVESOL	0	/* 1: input a solution; 0: do not give a solution */
+#define	FASTREAD 1	/* 0: fscanf; 1: block parser; 2: also print timings */
+#define	SEED	0	/* the seed of the random number generator */
+#define	STRATEGIES 15	/* the strategies to run, a bit each (STRATEGY_*) */
+#define	ELITE	10	/* solutions in the shared elite pool */
+#define	CHAIN	3	/* the longest ejection chain; 0: none */
+#define	CHAIN_WIDTH 3	/* agents per job and jobs per agent in a chain */
+#define	HISTORY	10000	/* the length of the history of LAHC */
+#define	SHARE	0.5	/* the probability to start from the elite pool */
+#define	KICK	0.05	/* the fraction of jobs moved at a start from the pool */
+#define	SLICE	1.0	/* CPU seconds of one run of annealing or LAHC */
+
+#define	STRATEGY_DESCENT 0	/* random starts, best shifts and ejection chains */
+#define	STRATEGY_GRASP	1	/* GRASP starts (grasp.c), then as DESCENT */
+#define	STRATEGY_ANNEAL	2	/* simulated annealing (anneal.c) */
+#define	STRATEGY_LAHC	3	/* late acceptance hill climbing */
+#define	STRATEGY_COUNT	4
+
+#define max( a, b ) ( ((a) > (b)) ? (a) : (b) )
+#define min( a, b ) ( ((a) < (b)) ? (a) : (b) )
+
+const int INFEASIBLE_COST = 20;
+
+typedef struct {
+  int		timelim;	/* the time limit for the algorithm in secs. */
+  int		givesol;	/* give a solution (1) or not (0) */
+  /* Never modify the above two lines.  */
+  /* You can add more components below. */
+  char		*binfile;	/* binary instance to map instead of STDIN */
+  int		fastread;	/* how to parse the text instance on STDIN */
+  int		seed;		/* the seed of the random number generator */
+  int		strategies;	/* the strategies to run, a bit each */
+  int		elite;		/* solutions in the shared elite pool */
+  int		chain;		/* the longest ejection chain */
+  int		history;	/* the length of the history of LAHC */
+} Param;			/* parameters */
+
+typedef struct {
+  int	n;	/* number of jobs */
+  int	m;	/* number of agents */
+  int	**c;	/* cost matrix c_{ij} */
+  int	**a;	/* resource requirement matrix a_{ij} */
+  int	*b;	/* available amount b_i of resource for each agent i */
+} GAPdata;	/* data of the generalized assignment problem */
+
+typedef struct {
+  double	timebrid;	/* the time before reading the instance data */
+  double	starttime;	/* the time the search started */
+  double	endtime;	/* the time the search ended */
+  int		*bestsol;	/* the best solution found so far */
+  /* Never modify the above four lines. */
+  /* You can add more components below. */
+} Vdata;		/* various data often necessary during the search */
+
+/*************************** functions ***************************************/
+void copy_parameters(int argc, char *arcv[], Param *param);
+void read_instance(GAPdata *gapdata);
+void prepare_memory(Vdata *vdata, GAPdata *gapdata);
+void free_memory(Vdata *vdata, GAPdata *gapdata);
+void read_sol(Vdata *vdata, GAPdata *gapdata);
+void recompute_cost(Vdata *vdata, GAPdata *gapdata);
+void *malloc_e(size_t size);
+
+#include "jobdata.c"
+#include "joblist.c"
+#include "eval.c"
+#include "penalty.c"
+#include "gapbin.c"
+#include "rng.c"
+#include "deadline.c"
+#include "ejection.c"
+#include "movequeue.c"
+#include "anneal.c"
+#include "lahc.c"
+#include "grasp.c"
+#include "incumbent.c"
+#include "elite.c"
+#include "fast_read.c"
+
+int descend(Evaldata *ev, Movequeue *mq, Ejection *ej, Rng *rng, int *best);
+void *strategy(void *arg);
+
+const char *STRATEGY_NAME[STRATEGY_COUNT] = {"descent", "grasp", "anneal", "lahc"};
+
+typedef struct {
+  _Alignas(64) long	epochs;	/* starts so far */
+  long		shared;		/* starts from a solution of another strategy */
+  long		entered;	/* solutions put into the elite pool */
+  long		bests;		/* new bests of all strategies */
+  long		shared_bests;	/* of which from a start of another strategy */
+  int		best_cost;	/* its best feasible cost; INT_MAX if none */
+  double	last;		/* its CPU seconds at its last new best of all */
+  double	cpu;		/* its CPU seconds in all */
+} Strategyslot;
+
+typedef struct {
+  GAPdata	*gapdata;	/* the instance, shared read-only */
+  const Jobdata	*jd;
+  Param		*param;
+  Incumbent	*inc;		/* the best solution of all strategies */
+  Elite		*elite;		/* the best distinct solutions of all strategies */
+  int		*strategy;	/* strategy[k]: the strategy of thread k */
+  Strategyslot	*slot;		/* slot[k]: the statistics of thread k */
+  double	timelim;	/* CPU seconds of each thread */
+  _Atomic int	next;		/* the next thread number to take */
+} Portfolio;
+
+/***** check the feasibility and recompute the cost **************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void recompute_cost(Vdata *vdata, GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	*rest_b;	/* the amount of resource available at each agent */
+  int	cost, penal;	/* the cost; the penalty = the total capacity excess */
+  int	temp;		/* temporary variable */
+
+  rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  cost = penal = 0;
+  for(i=0; i<gapdata->m; i++){rest_b[i] = gapdata->b[i];}
+  for(j=0; j<gapdata->n; j++){
+    rest_b[vdata->bestsol[j]] -= gapdata->a[vdata->bestsol[j]][j];
+    cost += gapdata->c[vdata->bestsol[j]][j];
+  }
+  for(i=0; i<gapdata->m; i++){
+    temp = rest_b[i];
+    if(temp<0){penal -= temp;}
+  }
+  printf("recomputed cost = %d\n", cost);
+  if(penal>0){
+    printf("INFEASIBLE!!\n");
+    printf(" resource left:");
+    for(i=0; i<gapdata->m; i++){printf(" %3d", rest_b[i]);}
+    printf("\n");
+  }
+  printf("time for the search:       %7.2f seconds\n",
+      vdata->endtime - vdata->starttime);
+  printf("time to read the instance: %7.2f seconds\n",
+      vdata->starttime - vdata->timebrid);
+
+  free((void *) rest_b);
+}
+
+/***** read a solution from STDIN ********************************************/
+void read_sol(Vdata *vdata, GAPdata *gapdata)
+{
+  int	j;		/* index of jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  for(j=0; j<gapdata->n; j++){
+    fscanf(fp, "%d", &value_read);
+    /* change the range of agents from [1, m] to [0, m-1] */
+    vdata->bestsol[j] = value_read - 1;
+  }
+}
+
+/***** prepare memory space **************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void prepare_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  int j;
+
+  vdata->bestsol = (int *)  malloc_e(gapdata->n * sizeof(int));
+  /* the next line is just to avoid confusion */
+  for(j=0; j<gapdata->n; j++){vdata->bestsol[j] = 0;}
+}
+
+/***** free memory space *****************************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void free_memory(Vdata *vdata, GAPdata *gapdata)
+{
+  free((void *) vdata->bestsol);
+  if(gapbin_release(gapdata)){return;}
+  free((void *) gapdata->c[0]);
+  free((void *) gapdata->c);
+  free((void *) gapdata->a[0]);
+  free((void *) gapdata->a);
+  free((void *) gapdata->b);
+}
+
+/***** read the instance data ************************************************/
+/***** NEVER MODIFY THIS SUBROUTINE! *****************************************/
+void read_instance(GAPdata *gapdata)
+{
+  int	i, j;		/* indices of agents and jobs */
+  int	value_read;	/* the value read by fscanf */
+  FILE	*fp=stdin;	/* set fp to the standard input */
+
+  /* read the number of agents and jobs */
+  fscanf(fp, "%d", &value_read);	/* number of agents */
+  gapdata->m = value_read;
+  fscanf(fp,"%d",&value_read);		/* number of jobs */
+  gapdata->n = value_read;
+
+  /* initialize memory */
+  gapdata->c    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->c[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->c[i] = gapdata->c[i-1] + gapdata->n;}
+  gapdata->a    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->a[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for(i=1; i<gapdata->m; i++){gapdata->a[i] = gapdata->a[i-1] + gapdata->n;}
+  gapdata->b    = (int *)  malloc_e(gapdata->m * sizeof(int));
+
+  /* read the cost coefficients */   
+  for(i=0; i<gapdata->m; i++){    
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->c[i][j] = value_read;
+    }
+  }
+
+  /* read the resource consumption */
+  for(i=0; i<gapdata->m; i++){
+    for(j=0; j<gapdata->n; j++){
+      fscanf(fp, "%d", &value_read);
+      gapdata->a[i][j] = value_read;
+    }
+  }
+
+  /* read the resource capacity */
+  for(i=0; i<gapdata->m; i++){    
+    fscanf(fp,"%d", &value_read);
+    gapdata->b[i] = value_read;
+  }
+}
+
+/***** copy and read the parameters ******************************************/
+/***** Feel free to modify this subroutine. **********************************/
+void copy_parameters(int argc, char *argv[], Param *param)
+{
+  int i;
+
+  /**** copy the parameters ****/
+  param->timelim = TIMELIM;
+  param->givesol = GIVESOL;
+  param->binfile = NULL;
+  param->fastread = FASTREAD;
+  param->seed = SEED;
+  param->strategies = STRATEGIES;
+  param->elite = ELITE;
+  param->chain = CHAIN;
+  param->history = HISTORY;
+  /**** read the parameters ****/
+  if(argc>0 && (argc % 2)==0){
+    printf("USAGE: ./gap [param_name, param_value] [name, value]...\n");
+    exit(EXIT_FAILURE);}
+  else{
+    for(i=1; i<argc; i+=2){
+      if(strcmp(argv[i],"timelim")==0) param->timelim = atoi(argv[i+1]);
+      if(strcmp(argv[i],"givesol")==0) param->givesol = atoi(argv[i+1]);
+      if(strcmp(argv[i],"binfile")==0) param->binfile = argv[i+1];
+      if(strcmp(argv[i],"fastread")==0) param->fastread = atoi(argv[i+1]);
+      if(strcmp(argv[i],"seed")==0) param->seed = atoi(argv[i+1]);
+      if(strcmp(argv[i],"strategies")==0) param->strategies = atoi(argv[i+1]);
+      if(strcmp(argv[i],"elite")==0) param->elite = max(1, atoi(argv[i+1]));
+      if(strcmp(argv[i],"chain")==0) param->chain = atoi(argv[i+1]);
+      if(strcmp(argv[i],"history")==0) param->history = max(1, atoi(argv[i+1]));
+    }
+  }
+}
+
+/***** malloc with error check ***********************************************/
+void *malloc_e( size_t size ) {
+  void *s;
+  if ( (s=malloc(size)) == NULL ) {
+    fprintf( stderr, "malloc : Not enough memory.\n" );
+    exit( EXIT_FAILURE );
+  }
+  return s;
+}
+
+
+/***** subroutines ***********************************************/
+/***** best shifts and ejection chains until neither improves ****************/
+/***** the cost of ev if it is feasible, copied into best; else INT_MAX ******/
+int descend(Evaldata *ev, Movequeue *mq, Ejection *ej, Rng *rng, int *best) {
+  /* a chain is applied only if it improves, so there are at most m rounds */
+  for (int chains=0; chains<ev->jd->m; chains++) {
+    movequeue_descent(mq, ev);
+    if (!ejection_chain(ej, ev, rng)) break;
+  }
+  if (ev->excess > 0) return INT_MAX;
+  for (int j=0; j<ev->jd->n; j++) best[j] = ev->sol[j];
+  return ev->cost;
+}
+
+/***** run one strategy until its thread has used its share of timelim *******/
+void *strategy(void *arg) {
+  Portfolio *pf = (Portfolio *) arg;
+  GAPdata *gapdata = pf->gapdata;
+  const Jobdata *jd = pf->jd;
+  Param *param = pf->param;
+  int k = atomic_fetch_add(&pf->next, 1);
+  int s = pf->strategy[k];
+  Strategyslot *slot = &pf->slot[k];
+  int *sol = (int *) malloc_e(gapdata->n * sizeof(int));
+  int *best = (int *) malloc_e(gapdata->n * sizeof(int));
+  int *rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  int owner, cost, j;
+  bool shared;
+  Evaldata ev;
+  Penalty pen;
+  Joblist jl;
+  Movequeue mq;
+  Ejection ej;
+  Anneal an;
+  Lahc lh;
+  Deadline dl, slice;
+  Rng rng;
+
+  /* the history of LAHC compares values over time, so its weights stay fixed */
+  if (s == STRATEGY_LAHC) {
+    penalty_init(&pen, gapdata->m, INFEASIBLE_COST, INFEASIBLE_COST, INFEASIBLE_COST);
+    lahc_init(&lh, param->history);
+  } else {
+    penalty_init(&pen, gapdata->m, INFEASIBLE_COST, 1, 100 * INFEASIBLE_COST);
+  }
+  joblist_init(&jl, gapdata->m, gapdata->n);
+  movequeue_init(&mq, jd);
+  ejection_init(&ej, param->chain, CHAIN_WIDTH, jd);
+  deadline_init_thread(&dl, pf->timelim);
+  rng_seed(&rng, param->seed, k + 1);
+
+  while (!dl.over) {
+    slot->epochs++;
+
+    /* start from a member of the pool, shaken a little, or from scratch */
+    owner = -1;
+    if (rng_double(&rng) < SHARE && elite_draw(pf->elite, sol, &owner, &rng) < INT_MAX) {
+      for (int kick=0; kick<max(1, (int) (gapdata->n * KICK)); kick++) {
+        j = rng_int(&rng, gapdata->n);
+        sol[j] = jd->by_ratio[j * jd->k + rng_int(&rng, jd->k)];
+      }
+    } else if (s == STRATEGY_GRASP) {
+      grasp_greedy(sol, &rng, gapdata);
+    } else {
+      rng_fill(&rng, sol, gapdata->n, gapdata->m);
+    }
+    shared = (owner >= 0 && owner != k);
+    if (shared) slot->shared++;
+
+    eval_init(&ev, sol, rest_b, pen.weight, jd, gapdata);
+    eval_jobs(&ev, &jl);
+    switch (s) {
+    case STRATEGY_ANNEAL:
+      deadline_init_thread(&slice, min(SLICE, dl.limit - deadline_elapsed(&dl)));
+      anneal_init(&an, ANNEAL_GEOMETRIC);
+      anneal_calibrate(&an, &ev, &rng);
+      cost = anneal_run(&an, &ev, &rng, &pen, &slice, best, INT_MAX, INT_MIN);
+      break;
+    case STRATEGY_LAHC:
+      deadline_init_thread(&slice, min(SLICE, dl.limit - deadline_elapsed(&dl)));
+      lahc_start(&lh, &ev);
+      cost = lahc_run(&lh, &ev, &rng, &slice, best, INT_MAX, INT_MIN);
+      break;
+    case STRATEGY_GRASP:
+      /* the swap descent of gap_GRASP_smallN.c, then the best shifts */
+      grasp_search(&ev, &rng, false, gapdata->n * 5);
+      cost = descend(&ev, &mq, &ej, &rng, best);
+      penalty_update(&pen, &ev, gapdata->m);
+      break;
+    default:
+      cost = descend(&ev, &mq, &ej, &rng, best);
+      penalty_update(&pen, &ev, gapdata->m);
+      break;
+    }
+    /* a start takes milliseconds at least, so read the clock after every one */
+    deadline_check(&dl);
+
+    if (cost == INT_MAX) continue;
+    slot->best_cost = min(slot->best_cost, cost);
+    if (elite_offer(pf->elite, best, cost, k)) slot->entered++;
+    if (incumbent_offer(pf->inc, best, cost)) {
+      slot->bests++;
+      if (shared) slot->shared_bests++;
+      slot->last = deadline_elapsed(&dl);
+    }
+  }
+  slot->cpu = deadline_elapsed(&dl);
+
+  penalty_free(&pen);
+  joblist_free(&jl);
+  movequeue_free(&mq);
+  ejection_free(&ej);
+  free((void *) sol);
+  free((void *) best);
+  free((void *) rest_b);
+  if (s == STRATEGY_LAHC) lahc_free(&lh);
+  return NULL;
+}
+
+/***** main ******************************************************************/
+int main(int argc, char *argv[])
+{
+  Param		param;		/* parameters */
+  GAPdata	gapdata;	/* GAP instance data */
+  Vdata		vdata;		/* various data often needed during search */
+
+  vdata.timebrid = cpu_time();
+  copy_parameters(argc, argv, &param);
+  if(param.binfile!=NULL){read_instance_bin(&gapdata, param.binfile);}
+  /* the block parser may consume the solution that follows the instance */
+  else if(param.fastread>0 && param.givesol!=1){
+    read_instance_fast(&gapdata, param.fastread==2);}
+  else{read_instance(&gapdata);}
+  prepare_memory(&vdata, &gapdata);
+  if(param.givesol==1){read_sol(&vdata, &gapdata);}
+  vdata.starttime = cpu_time();
+
+  /*
+     Write your program here. Of course you can add your subroutines
+     outside main(). At this point, the instance data is stored in "gapdata".
+     gapdata.n	number of jobs n
+     gapdata.m	number of agents m
+     gapdata.c[i][j]	cost c_{ij} {i, j} = {agent, job} 
+     gapdata.a[i][j]	resource requirement a_{ij} 
+     gapdata.b[i]	available amount b_i of resource at agent i
+     Note that i ranges from 0 to m-1, and j ranges from 0 to n-1. Note also
+     that  you should write, e.g., "gapdata->c[i][j]" in your subroutines.
+     Store your best solution in vdata.bestsol, then "recompute_cost" will
+     compute its cost and its feasibility. The format of vdata.bestsol is:
+     For each job j from 0 to n-1 in this order, the index of the agent 
+     (the value should be given as values from [0, m-1]) to which j is
+     assigned. For example, if n=4 and m=3, and jobs 0, 1, 2 and 3 are
+     assigned to agents 1, 0, 2 and 0, respectively, then vdata.bestsol
+     should be as follows:  
+     vdata.bestsol[0] = 1
+     vdata.bestsol[1] = 0
+     vdata.bestsol[2] = 2
+     vdata.bestsol[3] = 0.
+     Note that you should write "vdata->bestsol[j]" in your subroutines.
+     */
+
+  int threads = 0;
+  pthread_t *tid = (pthread_t *) malloc_e(STRATEGY_COUNT * sizeof(pthread_t));
+  Strategyslot *slot;
+  Incumbent inc;
+  Elite elite;
+  Jobdata jd;
+  Portfolio pf;
+  int started;
+
+  jobdata_build(&jd, &gapdata);
+  incumbent_init(&inc, gapdata.n);
+  elite_init(&elite, param.elite, gapdata.n, 1);
+  pf.gapdata = &gapdata;
+  pf.jd = &jd;
+  pf.param = &param;
+  pf.inc = &inc;
+  pf.elite = &elite;
+  pf.strategy = (int *) malloc_e(STRATEGY_COUNT * sizeof(int));
+  for (int s=0; s<STRATEGY_COUNT; s++) {
+    if (param.strategies & (1 << s)) pf.strategy[threads++] = s;
+  }
+  if (threads == 0) {
+    fprintf(stderr, "strategies : no strategy selected.\n");
+    exit(EXIT_FAILURE);
+  }
+  pf.slot = slot = (Strategyslot *) aligned_alloc(64, STRATEGY_COUNT * sizeof(Strategyslot));
+  if (slot == NULL) {
+    fprintf(stderr, "aligned_alloc : Not enough memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  for (int k=0; k<threads; k++) {
+    slot[k].epochs = slot[k].shared = slot[k].entered = 0;
+    slot[k].bests = slot[k].shared_bests = 0;
+    slot[k].best_cost = INT_MAX;
+    slot[k].last = slot[k].cpu = 0.0;
+  }
+  /* the strategies share timelim, so the process uses about timelim CPU seconds */
+  pf.timelim = param.timelim / (double) threads;
+  atomic_init(&pf.next, 0);
+
+  for (started=0; started<threads; started++) {
+    if (pthread_create(&tid[started], NULL, strategy, &pf) != 0) break;
+  }
+  if (started < threads) {
+    fprintf(stderr, "pthread_create : only %d of %d strategies.\n", started, threads);
+    exit(EXIT_FAILURE);
+  }
+  for (int k=0; k<started; k++) pthread_join(tid[k], NULL);
+
+  /* what each strategy contributed to the others and to the result */
+  printf("strategy    cpu  starts  shared  entered  bests  shared_bests   best  last\n");
+  for (int k=0; k<threads; k++) {
+    printf("%-8s %6.2f %7ld %7ld %8ld %6ld %13ld %6d %5.2f\n",
+        STRATEGY_NAME[pf.strategy[k]], slot[k].cpu, slot[k].epochs,
+        slot[k].shared, slot[k].entered, slot[k].bests, slot[k].shared_bests,
+        (slot[k].best_cost < INT_MAX) ? slot[k].best_cost : -1, slot[k].last);
+  }
+  if (incumbent_cost(&inc) < INT_MAX) incumbent_read(&inc, vdata.bestsol);
+
+  vdata.endtime = cpu_time();
+  recompute_cost(&vdata, &gapdata);
+  free_memory(&vdata, &gapdata);
+  elite_free(&elite);
+  incumbent_free(&inc);
+  jobdata_free(&jd);
+  free((void *) pf.strategy);
+  free((void *) slot);
+  free((void *) tid);
+
+  return EXIT_SUCCESS;
+}
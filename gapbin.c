@@ -0,0 +1,167 @@
+/******************************************************************************
+  Binary instance files that can be mapped into GAPdata without parsing.
+
+  A binary instance starts with a GAPbinheader, followed by the cost matrix
+  c and the resource matrix a (both agent-major m x n, as in GAPdata) and
+  the capacities b. Every block starts at the offset given in the header,
+  aligned to GAPBIN_ALIGN bytes, and holds values of "width" bytes in the
+  byte order of the machine that wrote it. Files are written by "gapconv".
+
+  read_instance_bin() maps the file read-only and points the rows of
+  gapdata->c and gapdata->a directly into it, so loading does not touch the
+  data at all. Release it with gapbin_release(). A file whose header does
+  not match this machine, or whose blocks do not lie within the file, is
+  rejected before any of it is used.
+
+  Include this file after the definition of GAPdata.
+******************************************************************************/
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define GAPBIN_MAGIC	"GAPB"
+#define GAPBIN_VERSION	1
+#define GAPBIN_ENDIAN	0x01020304
+#define GAPBIN_ALIGN	64
+
+typedef struct {
+  char		magic[4];	/* "GAPB" */
+  int32_t	version;	/* GAPBIN_VERSION */
+  int32_t	endian;		/* GAPBIN_ENDIAN in the writer's byte order */
+  int32_t	width;		/* bytes per value of c, a and b */
+  int32_t	m;		/* number of agents */
+  int32_t	n;		/* number of jobs */
+  int64_t	off_c;		/* offset of the cost matrix c */
+  int64_t	off_a;		/* offset of the resource matrix a */
+  int64_t	off_b;		/* offset of the capacities b */
+  int64_t	size;		/* total size of the file */
+} GAPbinheader;
+
+static void	*gapbin_base = NULL;	/* the mapped file, if any */
+static size_t	gapbin_size = 0;
+
+/***** offsets of the blocks of an m x n instance ****************************/
+void gapbin_layout(GAPbinheader *h, int m, int n) {
+  int64_t off = sizeof(GAPbinheader);
+  int64_t mat = (int64_t) m * n * sizeof(int);
+
+  memcpy(h->magic, GAPBIN_MAGIC, 4);
+  h->version = GAPBIN_VERSION;
+  h->endian = GAPBIN_ENDIAN;
+  h->width = sizeof(int);
+  h->m = m;
+  h->n = n;
+  off = (off + GAPBIN_ALIGN - 1) / GAPBIN_ALIGN * GAPBIN_ALIGN;
+  h->off_c = off;
+  off = (off + mat + GAPBIN_ALIGN - 1) / GAPBIN_ALIGN * GAPBIN_ALIGN;
+  h->off_a = off;
+  off = (off + mat + GAPBIN_ALIGN - 1) / GAPBIN_ALIGN * GAPBIN_ALIGN;
+  h->off_b = off;
+  h->size = off + (int64_t) m * sizeof(int);
+}
+
+/***** write count values at offset off, padding from *pos with zeros ******/
+static bool gapbin_block(FILE *fp, int64_t *pos, int64_t off,
+    const int *v, size_t count) {
+  static const char zero[GAPBIN_ALIGN];
+
+  if (off > *pos && fwrite(zero, off - *pos, 1, fp) != 1) return false;
+  if (fwrite(v, sizeof(int), count, fp) != count) return false;
+  *pos = off + (int64_t) (count * sizeof(int));
+  return true;
+}
+
+/***** write gapdata as a binary instance ************************************/
+bool gapbin_write(FILE *fp, GAPdata *gapdata) {
+  GAPbinheader h;
+  int64_t pos = sizeof(h);
+  size_t mat = (size_t) gapdata->m * gapdata->n;
+
+  memset(&h, 0, sizeof(h));
+  gapbin_layout(&h, gapdata->m, gapdata->n);
+
+  return fwrite(&h, sizeof(h), 1, fp) == 1
+    && gapbin_block(fp, &pos, h.off_c, gapdata->c[0], mat)
+    && gapbin_block(fp, &pos, h.off_a, gapdata->a[0], mat)
+    && gapbin_block(fp, &pos, h.off_b, gapdata->b, gapdata->m)
+    && fflush(fp) == 0;
+}
+
+/***** true if every block of h lies within a file of size bytes ***********/
+static bool gapbin_fits(const GAPbinheader *h, int64_t size) {
+  int64_t head = sizeof(GAPbinheader), width = sizeof(int);
+  int64_t mat, vec;
+
+  /* m and n are positive int32_t, so m n itself does not overflow */
+  if ((int64_t) h->m * h->n > (size - head) / width) return false;
+  mat = (int64_t) h->m * h->n * width;
+  vec = (int64_t) h->m * width;
+  return h->off_c >= head && h->off_c % width == 0 && h->off_c <= size - mat
+    && h->off_a >= head && h->off_a % width == 0 && h->off_a <= size - mat
+    && h->off_b >= head && h->off_b % width == 0 && h->off_b <= size - vec;
+}
+
+/***** map a binary instance into gapdata ************************************/
+void read_instance_bin(GAPdata *gapdata, const char *path) {
+  GAPbinheader h;
+  struct stat st;
+  char *base;
+  int fd;
+
+  if ((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+    fprintf(stderr, "gapbin : cannot open %s.\n", path);
+    exit(EXIT_FAILURE);
+  }
+  if ((size_t) st.st_size < sizeof(h)) {
+    fprintf(stderr, "gapbin : %s is not a binary instance.\n", path);
+    exit(EXIT_FAILURE);
+  }
+  base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    fprintf(stderr, "gapbin : cannot map %s.\n", path);
+    exit(EXIT_FAILURE);
+  }
+
+  memcpy(&h, base, sizeof(h));
+  if (memcmp(h.magic, GAPBIN_MAGIC, 4) != 0 || h.version != GAPBIN_VERSION
+      || h.endian != GAPBIN_ENDIAN || h.width != sizeof(int)
+      || h.m <= 0 || h.n <= 0 || h.size > st.st_size) {
+    fprintf(stderr, "gapbin : %s is not a binary instance for this machine.\n", path);
+    exit(EXIT_FAILURE);
+  }
+  if (!gapbin_fits(&h, st.st_size)) {
+    fprintf(stderr, "gapbin : %s is truncated or corrupt.\n", path);
+    exit(EXIT_FAILURE);
+  }
+
+  gapbin_base = base;
+  gapbin_size = st.st_size;
+
+  gapdata->m = h.m;
+  gapdata->n = h.n;
+  gapdata->c    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->c[0] = (int *)  (base + h.off_c);
+  for (int i=1; i<gapdata->m; i++) gapdata->c[i] = gapdata->c[i-1] + gapdata->n;
+  gapdata->a    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->a[0] = (int *)  (base + h.off_a);
+  for (int i=1; i<gapdata->m; i++) gapdata->a[i] = gapdata->a[i-1] + gapdata->n;
+  gapdata->b    = (int *)  (base + h.off_b);
+}
+
+/***** unmap gapdata if it was mapped; returns false if it was not ***********/
+bool gapbin_release(GAPdata *gapdata) {
+  if (gapbin_base == NULL || (char *) gapdata->b < (char *) gapbin_base
+      || (char *) gapdata->b >= (char *) gapbin_base + gapbin_size) {
+    return false;
+  }
+  free((void *) gapdata->c);
+  free((void *) gapdata->a);
+  munmap(gapbin_base, gapbin_size);
+  gapbin_base = NULL;
+  gapbin_size = 0;
+  return true;
+}
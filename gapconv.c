@@ -0,0 +1,116 @@
+/******************************************************************************
+  gapconv: convert GAP instances from the text format of "data/" into the
+  binary format of gapbin.c, which the solvers map with "binfile <file>".
+
+  USAGE: ./gapconv < data/c05100 > c05100.gapb
+         ./gapconv data/c05100 data/d10200 ...
+
+  With file arguments, each instance "x" is written to "x.gapb".
+******************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+typedef struct {
+  int	n;	/* number of jobs */
+  int	m;	/* number of agents */
+  int	**c;	/* cost matrix c_{ij} */
+  int	**a;	/* resource requirement matrix a_{ij} */
+  int	*b;	/* available amount b_i of resource for each agent i */
+} GAPdata;	/* data of the generalized assignment problem */
+
+void *malloc_e(size_t size);
+
+#include "gapbin.c"
+
+/***** malloc with error check ***********************************************/
+void *malloc_e( size_t size ) {
+  void *s;
+  if ( (s=malloc(size)) == NULL ) {
+    fprintf( stderr, "malloc : Not enough memory.\n" );
+    exit( EXIT_FAILURE );
+  }
+  return s;
+}
+
+/***** read a text instance, in the same way as read_instance() **************/
+bool read_text(FILE *fp, GAPdata *gapdata) {
+  if (fscanf(fp, "%d %d", &gapdata->m, &gapdata->n) != 2
+      || gapdata->m <= 0 || gapdata->n <= 0) return false;
+
+  gapdata->c    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->c[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for (int i=1; i<gapdata->m; i++) gapdata->c[i] = gapdata->c[i-1] + gapdata->n;
+  gapdata->a    = (int **) malloc_e(gapdata->m * sizeof(int *));
+  gapdata->a[0] = (int *)  malloc_e(gapdata->m * gapdata->n * sizeof(int));
+  for (int i=1; i<gapdata->m; i++) gapdata->a[i] = gapdata->a[i-1] + gapdata->n;
+  gapdata->b    = (int *)  malloc_e(gapdata->m * sizeof(int));
+
+  for (int k=0; k<gapdata->m * gapdata->n; k++) {
+    if (fscanf(fp, "%d", &gapdata->c[0][k]) != 1) return false;
+  }
+  for (int k=0; k<gapdata->m * gapdata->n; k++) {
+    if (fscanf(fp, "%d", &gapdata->a[0][k]) != 1) return false;
+  }
+  for (int i=0; i<gapdata->m; i++) {
+    if (fscanf(fp, "%d", &gapdata->b[i]) != 1) return false;
+  }
+  return true;
+}
+
+void free_text(GAPdata *gapdata) {
+  free((void *) gapdata->c[0]);
+  free((void *) gapdata->c);
+  free((void *) gapdata->a[0]);
+  free((void *) gapdata->a);
+  free((void *) gapdata->b);
+}
+
+/***** convert one instance **************************************************/
+bool convert(FILE *in, FILE *out, const char *name) {
+  GAPdata gapdata;
+  bool ok;
+
+  if (!read_text(in, &gapdata)) {
+    fprintf(stderr, "gapconv : cannot read an instance from %s.\n", name);
+    return false;
+  }
+  ok = gapbin_write(out, &gapdata);
+  if (!ok) fprintf(stderr, "gapconv : cannot write %s.\n", name);
+  free_text(&gapdata);
+  return ok;
+}
+
+/***** main ******************************************************************/
+int main(int argc, char *argv[])
+{
+  char path[FILENAME_MAX];
+  FILE *in, *out;
+  bool ok = true;
+
+  if (argc == 1) {
+    return convert(stdin, stdout, "STDIN") ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  for (int k=1; k<argc; k++) {
+    snprintf(path, sizeof(path), "%s.gapb", argv[k]);
+    if ((in = fopen(argv[k], "r")) == NULL) {
+      fprintf(stderr, "gapconv : cannot open %s.\n", argv[k]);
+      ok = false;
+      continue;
+    }
+    if ((out = fopen(path, "wb")) == NULL) {
+      fprintf(stderr, "gapconv : cannot open %s.\n", path);
+      fclose(in);
+      ok = false;
+      continue;
+    }
+    ok = convert(in, out, argv[k]) && ok;
+    fclose(in);
+    if (fclose(out) != 0) ok = false;
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,69 @@
+/******************************************************************************
+  The randomized greedy start and the swap descent of the GRASP programs.
+
+  grasp_greedy() assigns the jobs in order, each to an agent drawn with a
+  probability inversely proportional to 3 c_{ij} + 2 a_{ij} plus the excess
+  of agent i so far; the start may be infeasible.
+
+  grasp_search() then swaps the agents of two random jobs whenever that
+  lowers the penalized value of the Evaldata. The swaps come in rounds:
+  gap_GRASP_smallN.c draws one random pair per round, gap_GRASP_largeN.c
+  ("sweep") pairs every job in turn with a random one. The descent stops
+  when "limit" rounds in a row have not lowered the value. Every swap is
+  evaluated with eval_swap_delta() and made with eval_swap() in O(1), so a
+  round no longer recomputes the cost and the penalty in O(n + m).
+
+  Include this file after eval.c and rng.c.
+******************************************************************************/
+
+/***** a random start, each job drawn by the greedy weights ******************/
+void grasp_greedy(int *sol, Rng *rng, GAPdata *gapdata) {
+  float sum, rnd;
+  int *vals = (int *) malloc_e(gapdata->m * sizeof(int));
+  int *rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  for (int i=0; i<gapdata->m; i++) rest_b[i] = gapdata->b[i];
+
+  for (int j=0; j<gapdata->n; j++) {
+    sum = 0;
+    for (int i=0; i<gapdata->m; i++) {
+      vals[i] = 3 * gapdata->c[i][j] + 2 * gapdata->a[i][j] - min(0, rest_b[i]);
+      sum += ((1.0 / vals[i]) * 2);
+    }
+
+    /* the last agent if rounding leaves rnd just above 0 */
+    rnd = rng_double(rng) * sum;
+    sol[j] = gapdata->m - 1;
+    for (int i=0; i<gapdata->m; i++) {
+      rnd -= ((1.0 / vals[i]) * 2);
+      if (rnd < 0) {
+        sol[j] = i;
+        break;
+      }
+    }
+    rest_b[sol[j]] -= gapdata->a[sol[j]][j];
+  }
+
+  free((void *) vals);
+  free((void *) rest_b);
+}
+
+/***** improving random swaps until limit rounds in a row find none **********/
+/***** a round is one random pair, or every job with a random one if sweep ***/
+/***** returns the penalized value of ev *************************************/
+int grasp_search(Evaldata *ev, Rng *rng, bool sweep, int limit) {
+  int n = ev->jd->n, round = sweep ? n : 1;
+  int idle = 0, j1, j2;
+
+  while (idle < limit) {
+    idle++;
+    for (int k=0; k<round; k++) {
+      j1 = sweep ? k : rng_int(rng, n);
+      j2 = rng_int(rng, n);
+      if (eval_swap_delta(ev, j1, j2).value < 0) {
+        eval_swap(ev, j1, j2);
+        idle = 0;
+      }
+    }
+  }
+  return eval_value(ev);
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+  The best solution found so far, shared by several search threads.
+
+  The cost is an atomic int, so a thread can check whether its solution is
+  an improvement without taking any lock. The solution itself is protected
+  by a sequence lock: a writer makes "seq" odd while it copies, and readers
+  retry until they have copied it between two reads of the same even
+  "seq". Readers never block writers, and writers only wait for each other
+  when they improve the incumbent at the same moment, which is rare.
+
+  Every improvement prints a "BEST Cost: c Time: t" line (see deadline.c)
+  with the CPU seconds of the whole process since incumbent_init().
+******************************************************************************/
+
+#include <stdatomic.h>
+
+typedef struct {
+  _Atomic int		cost;	/* the best cost so far; INT_MAX if none */
+  _Atomic unsigned	seq;	/* even: sol is stable; odd: being written */
+  int			n;	/* number of jobs */
+  _Atomic int		*sol;	/* the best solution so far */
+  double		start;	/* cpu_time() at incumbent_init() */
+} Incumbent;
+
+void incumbent_init(Incumbent *inc, int n) {
+  atomic_init(&inc->cost, INT_MAX);
+  atomic_init(&inc->seq, 0);
+  inc->n = n;
+  inc->start = cpu_time();
+  inc->sol = (_Atomic int *) malloc_e(n * sizeof(_Atomic int));
+  for (int j=0; j<n; j++) atomic_init(&inc->sol[j], 0);
+}
+
+void incumbent_free(Incumbent *inc) {
+  free((void *) inc->sol);
+}
+
+/***** the best cost so far, without locking *********************************/
+static inline int incumbent_cost(Incumbent *inc) {
+  return atomic_load_explicit(&inc->cost, memory_order_relaxed);
+}
+
+/***** replace the incumbent by sol if cost is better; true if replaced ******/
+bool incumbent_offer(Incumbent *inc, const int *sol, int cost) {
+  unsigned seq;
+  bool better;
+
+  if (cost >= incumbent_cost(inc)) return false;
+
+  for (;;) {
+    seq = atomic_load_explicit(&inc->seq, memory_order_relaxed);
+    if (!(seq & 1) && atomic_compare_exchange_weak_explicit(&inc->seq,
+          &seq, seq + 1, memory_order_acquire, memory_order_relaxed)) break;
+  }
+  /* the odd seq must be visible before any of the stores below */
+  atomic_thread_fence(memory_order_release);
+
+  better = cost < atomic_load_explicit(&inc->cost, memory_order_relaxed);
+  if (better) {
+    for (int j=0; j<inc->n; j++) {
+      atomic_store_explicit(&inc->sol[j], sol[j], memory_order_relaxed);
+    }
+    atomic_store_explicit(&inc->cost, cost, memory_order_relaxed);
+    printf("BEST Cost: %d Time: %f\n", cost, cpu_time() - inc->start);
+  }
+  atomic_store_explicit(&inc->seq, seq + 2, memory_order_release);
+
+  return better;
+}
+
+/***** copy the incumbent into sol and return its cost ***********************/
+int incumbent_read(Incumbent *inc, int *sol) {
+  unsigned before, after;
+  int cost;
+
+  do {
+    before = atomic_load_explicit(&inc->seq, memory_order_acquire);
+    cost = atomic_load_explicit(&inc->cost, memory_order_relaxed);
+    for (int j=0; j<inc->n; j++) {
+      sol[j] = atomic_load_explicit(&inc->sol[j], memory_order_relaxed);
+    }
+    atomic_thread_fence(memory_order_acquire);
+    after = atomic_load_explicit(&inc->seq, memory_order_relaxed);
+  } while ((before & 1) || before != after);
+
+  return cost;
+}
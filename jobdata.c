@@ -0,0 +1,204 @@
+/******************************************************************************
+  Job-major copy of the cost and resource matrices.
+
+  GAPdata stores c and a as two agent-major m x n matrices, so evaluating a
+  move of job j touches a different row (and cache line) for every agent
+  and for c and a separately. Jobdata interleaves them per job:
+
+    ca[j*m + i] = {c_{ij}, a_{ij}}
+
+  so that everything the search needs about job j lies in one contiguous
+  block of m pairs. The agent-major GAPdata is left as it is, e.g., for
+  recompute_cost().
+
+  The pairs are stored with the narrowest integer type (8, 16 or 32 bits)
+  that holds every c_{ij} and a_{ij} of the instance, chosen when the copy
+  is built. All instances in "data/" fit in 16 bits, and the c- and d-types
+  in 8 bits, which cuts the memory traffic of the search by a factor of 4
+  or 8 compared with two int matrices.
+
+  For every job, the best k = min(JOBDATA_TOPK, m) agents are also listed
+  by cost, by resource requirement and by the sum of both relative to
+  their averages, c_{ij} / avg(c) + a_{ij} / avg(a), so that a move can
+  draw its target from the few agents worth trying instead of all m.
+  jobdata_greedy() builds a start from the by_cost lists.
+
+  Include this file after the definition of GAPdata.
+******************************************************************************/
+
+#include <stdint.h>
+
+#define JOBDATA_TOPK	8	/* agents in the candidate lists of a job */
+
+typedef struct { int8_t  c, a; } Jobagent8;	/* job j at agent i */
+typedef struct { int16_t c, a; } Jobagent16;
+typedef struct { int32_t c, a; } Jobagent32;
+
+typedef struct {
+  int	n;	/* number of jobs */
+  int	m;	/* number of agents */
+  int	width;	/* bytes per value: 1, 2 or 4 */
+  void	*ca;	/* ca[j*m + i] = {c_{ij}, a_{ij}} of the above width */
+  int	k;	/* agents per candidate list */
+  int	*by_cost;	/* by_cost[j*k + r]: the agent of job j with the r-th least c */
+  int	*by_resource;	/* the same for a */
+  int	*by_ratio;	/* the same for c / avg(c) + a / avg(a) */
+} Jobdata;
+
+#define JOBDATA_AT(jd, T, j, i) (((const T *) (jd)->ca)[(size_t) (j) * (jd)->m + (i)])
+
+/***** the narrowest width that holds the values in [lo, hi] *****************/
+static int jobdata_width(int lo, int hi) {
+  if (lo >= INT8_MIN && hi <= INT8_MAX) return 1;
+  if (lo >= INT16_MIN && hi <= INT16_MAX) return 2;
+  return 4;
+}
+
+/***** fill ca with elements of type T ***************************************/
+#define JOBDATA_FILL(T) \
+  for (int j=0; j<jd->n; j++) { \
+    for (int i=0; i<jd->m; i++) { \
+      T *p = (T *) jd->ca + (size_t) j * jd->m + i; \
+      p->c = gapdata->c[i][j]; \
+      p->a = gapdata->a[i][j]; \
+    } \
+  }
+
+/***** the k agents of job j with the least key[i], in increasing order ****/
+static void jobdata_topk(int *list, int k, const double *key, int m) {
+  int r;
+
+  for (int i=0, len=0; i<m; i++) {
+    if (len == k && key[i] >= key[list[k-1]]) continue;
+    if (len < k) len++;
+    for (r=len-1; r>0 && key[list[r-1]] > key[i]; r--) list[r] = list[r-1];
+    list[r] = i;
+  }
+}
+
+/***** the candidate lists of every job **************************************/
+static void jobdata_candidates(Jobdata *jd, GAPdata *gapdata) {
+  double *key = (double *) malloc_e(jd->m * sizeof(double));
+  double avg_c = 0.0, avg_a = 0.0;
+
+  jd->k = min(JOBDATA_TOPK, jd->m);
+  jd->by_cost = (int *) malloc_e(jd->n * jd->k * sizeof(int));
+  jd->by_resource = (int *) malloc_e(jd->n * jd->k * sizeof(int));
+  jd->by_ratio = (int *) malloc_e(jd->n * jd->k * sizeof(int));
+
+  for (int i=0; i<jd->m; i++) {
+    for (int j=0; j<jd->n; j++) {
+      avg_c += gapdata->c[i][j];
+      avg_a += gapdata->a[i][j];
+    }
+  }
+  avg_c = max(avg_c / jd->m / jd->n, 1e-9);
+  avg_a = max(avg_a / jd->m / jd->n, 1e-9);
+
+  for (int j=0; j<jd->n; j++) {
+    for (int i=0; i<jd->m; i++) key[i] = gapdata->c[i][j];
+    jobdata_topk(jd->by_cost + j * jd->k, jd->k, key, jd->m);
+    for (int i=0; i<jd->m; i++) key[i] = gapdata->a[i][j];
+    jobdata_topk(jd->by_resource + j * jd->k, jd->k, key, jd->m);
+    for (int i=0; i<jd->m; i++) key[i] = gapdata->c[i][j] / avg_c + gapdata->a[i][j] / avg_a;
+    jobdata_topk(jd->by_ratio + j * jd->k, jd->k, key, jd->m);
+  }
+  free((void *) key);
+}
+
+/***** build the job-major copy of gapdata ***********************************/
+void jobdata_build(Jobdata *jd, GAPdata *gapdata) {
+  int lo = 0, hi = 0;
+
+  jd->n = gapdata->n;
+  jd->m = gapdata->m;
+  for (int i=0; i<jd->m; i++) {
+    for (int j=0; j<jd->n; j++) {
+      lo = min(lo, min(gapdata->c[i][j], gapdata->a[i][j]));
+      hi = max(hi, max(gapdata->c[i][j], gapdata->a[i][j]));
+    }
+  }
+  jd->width = jobdata_width(lo, hi);
+  jd->ca = malloc_e((size_t) jd->n * jd->m * 2 * jd->width);
+
+  switch (jd->width) {
+  case 1: JOBDATA_FILL(Jobagent8); break;
+  case 2: JOBDATA_FILL(Jobagent16); break;
+  default: JOBDATA_FILL(Jobagent32); break;
+  }
+  jobdata_candidates(jd, gapdata);
+}
+
+void jobdata_free(Jobdata *jd) {
+  free(jd->ca);
+  free((void *) jd->by_cost);
+  free((void *) jd->by_resource);
+  free((void *) jd->by_ratio);
+}
+
+/***** c_{ij} and a_{ij} *****************************************************/
+static inline int jobdata_c(const Jobdata *jd, int j, int i) {
+  switch (jd->width) {
+  case 1: return JOBDATA_AT(jd, Jobagent8, j, i).c;
+  case 2: return JOBDATA_AT(jd, Jobagent16, j, i).c;
+  default: return JOBDATA_AT(jd, Jobagent32, j, i).c;
+  }
+}
+
+static inline int jobdata_a(const Jobdata *jd, int j, int i) {
+  switch (jd->width) {
+  case 1: return JOBDATA_AT(jd, Jobagent8, j, i).a;
+  case 2: return JOBDATA_AT(jd, Jobagent16, j, i).a;
+  default: return JOBDATA_AT(jd, Jobagent32, j, i).a;
+  }
+}
+
+/***** each job to its cheapest agent with room left, or its cheapest agent **/
+void jobdata_greedy(const Jobdata *jd, const int *b, int *sol) {
+  int *rest_b = (int *) malloc_e(jd->m * sizeof(int));
+  int fit, any;
+
+  for (int i=0; i<jd->m; i++) rest_b[i] = b[i];
+  for (int j=0; j<jd->n; j++) {
+    /* the candidate list usually has an agent with room left */
+    sol[j] = -1;
+    for (int r=0; r<jd->k && sol[j]<0; r++) {
+      fit = jd->by_cost[j * jd->k + r];
+      if (jobdata_a(jd, j, fit) <= rest_b[fit]) sol[j] = fit;
+    }
+    if (sol[j] >= 0) {
+      rest_b[sol[j]] -= jobdata_a(jd, j, sol[j]);
+      continue;
+    }
+
+    fit = any = 0;
+    for (int i=0; i<jd->m; i++) {
+      if (jobdata_c(jd, j, i) < jobdata_c(jd, j, any)) any = i;
+      if (jobdata_a(jd, j, i) <= rest_b[i]
+          && (jobdata_a(jd, j, fit) > rest_b[fit]
+            || jobdata_c(jd, j, i) < jobdata_c(jd, j, fit))) fit = i;
+    }
+    sol[j] = (jobdata_a(jd, j, fit) <= rest_b[fit]) ? fit : any;
+    rest_b[sol[j]] -= jobdata_a(jd, j, sol[j]);
+  }
+  free((void *) rest_b);
+}
+
+/***** the cost of sol; the resource it uses is subtracted from rest_b *******/
+#define JOBDATA_LOAD(T) \
+  for (int j=0; j<jd->n; j++) { \
+    const T *p = (const T *) jd->ca + (size_t) j * jd->m + sol[j]; \
+    cost += p->c; \
+    rest_b[sol[j]] -= p->a; \
+  }
+
+int jobdata_load(const Jobdata *jd, const int *sol, int *rest_b) {
+  int cost = 0;
+
+  switch (jd->width) {
+  case 1: JOBDATA_LOAD(Jobagent8); break;
+  case 2: JOBDATA_LOAD(Jobagent16); break;
+  default: JOBDATA_LOAD(Jobagent32); break;
+  }
+  return cost;
+}
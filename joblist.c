@@ -0,0 +1,67 @@
+/******************************************************************************
+  The jobs assigned to each agent.
+
+  sol[j] gives the agent of job j, but agent-centric moves (shifting the
+  jobs off an overloaded agent, finding a job to eject from it) need the
+  jobs of one agent, and scanning all n jobs for them costs O(n). A Joblist
+  keeps, next to sol, the jobs of every agent in an array
+
+    job[i*n + 0], ..., job[i*n + count[i] - 1]
+
+  in no particular order, and the position pos[j] of every job in the array
+  of its agent. A job leaves its array by moving the last job of the array
+  into its place, so a move is O(1). Attach a Joblist to an Evaldata with
+  eval_jobs(), and every eval_move() and eval_swap() keeps it up to date.
+
+  Removing the k-th job only moves the last one, so the jobs of an agent
+  can be visited from the last one down to the first while they move away.
+
+  Include this file after the definition of GAPdata.
+******************************************************************************/
+
+typedef struct {
+  int	m;		/* number of agents */
+  int	n;		/* number of jobs */
+  int	*job;		/* job[i*n + k]: the k-th job at agent i */
+  int	*count;		/* the number of jobs at each agent */
+  int	*pos;		/* pos[j]: the position of job j at its agent */
+} Joblist;
+
+void joblist_init(Joblist *jl, int m, int n) {
+  jl->m = m;
+  jl->n = n;
+  jl->job = (int *) malloc_e((size_t) m * n * sizeof(int));
+  jl->count = (int *) malloc_e(m * sizeof(int));
+  jl->pos = (int *) malloc_e(n * sizeof(int));
+}
+
+void joblist_free(Joblist *jl) {
+  free((void *) jl->job);
+  free((void *) jl->count);
+  free((void *) jl->pos);
+}
+
+/***** the k-th job at agent i ***********************************************/
+static inline int joblist_job(const Joblist *jl, int i, int k) {
+  return jl->job[(size_t) i * jl->n + k];
+}
+
+/***** fill the lists from the solution sol **********************************/
+void joblist_build(Joblist *jl, const int *sol) {
+  for (int i=0; i<jl->m; i++) jl->count[i] = 0;
+  for (int j=0; j<jl->n; j++) {
+    jl->pos[j] = jl->count[sol[j]]++;
+    jl->job[(size_t) sol[j] * jl->n + jl->pos[j]] = j;
+  }
+}
+
+/***** move job j from agent "from" to agent "to" ****************************/
+static inline void joblist_move(Joblist *jl, int j, int from, int to) {
+  int *list = jl->job + (size_t) from * jl->n;
+  int last = list[--jl->count[from]];
+
+  list[jl->pos[j]] = last;
+  jl->pos[last] = jl->pos[j];
+  jl->pos[j] = jl->count[to]++;
+  jl->job[(size_t) to * jl->n + jl->pos[j]] = j;
+}
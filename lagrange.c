@@ -0,0 +1,197 @@
+/******************************************************************************
+  A lower bound from the Lagrangian relaxation of the assignment constraints.
+
+  With a multiplier u_j for the constraint "job j is assigned exactly once",
+
+    L(u) = sum_j u_j + sum_i min { sum_j (c_{ij} - u_j) x_{ij} :
+                                   sum_j a_{ij} x_{ij} <= b_i, x_{ij} in {0,1} }
+
+  is a lower bound of the optimal cost for every u, and the minimization
+  splits into one 0-1 knapsack problem per agent, which is solved exactly
+  by dynamic programming over the capacity (b_i is at most a few hundred in
+  "data/"). Only jobs with c_{ij} < u_j can improve the knapsack of agent i.
+
+  lagrange_bound() improves u by subgradient steps
+
+    u_j += step * (1 - sum_i x_{ij}),  step = lambda (target - L(u)) / |g|^2
+
+  where lambda is halved whenever the bound has not improved for
+  LAGRANGE_PATIENCE iterations. Since every cost is an integer, the bound
+  is rounded up. If a subgradient is zero, the knapsack solutions assign
+  every job exactly once and are optimal, so the bound is exact.
+
+  One iteration solves m knapsacks in O(n max b), which takes milliseconds
+  on the larger instances, so a search does not call lagrange_bound() on
+  its own clock. lagrange_start() computes the first bound, and
+  lagrange_update() tightens it with the cost of the best solution as the
+  target of the steps, at most every LAGRANGE_EVERY of the time limit and
+  LAGRANGE_STEPS iterations at a time. Together they stop as soon as they
+  have used LAGRANGE_SHARE of the time limit, or the limit is over, which
+  is checked after every iteration.
+
+  Include this file after deadline.c.
+******************************************************************************/
+
+#define LAGRANGE_PATIENCE	20	/* iterations before lambda is halved */
+#define LAGRANGE_EPS		1e-6
+#define LAGRANGE_SHARE		0.1	/* the most of the time limit for the bound */
+#define LAGRANGE_EVERY		0.05	/* time limit fraction between two updates */
+#define LAGRANGE_STEPS		10	/* iterations of one update */
+
+typedef struct {
+  int		n;		/* number of jobs */
+  int		m;		/* number of agents */
+  double	*u;		/* the multipliers */
+  int		*g;		/* the subgradient 1 - sum_i x_{ij} */
+  double	*f;		/* f[w]: best knapsack profit within capacity w */
+  int		*item;		/* the jobs in the current knapsack */
+  char		*keep;		/* keep[k*(maxb+1) + w]: item k taken at capacity w */
+  int		maxb;		/* the largest capacity */
+  double	lambda;		/* the step size factor */
+  int		since;		/* iterations since the bound last improved */
+  double	value;		/* the best L(u) so far */
+  int		bound;		/* the best lower bound so far */
+  int		iter;		/* subgradient iterations so far */
+  bool		exact;		/* the bound is the optimal cost */
+  double	spent;		/* CPU seconds of lagrange_start() and _update() */
+  double	next;		/* the CPU time of the next lagrange_update() */
+} Lagrange;
+
+void lagrange_init(Lagrange *lg, GAPdata *gapdata) {
+  int c;
+
+  lg->n = gapdata->n;
+  lg->m = gapdata->m;
+  lg->maxb = 0;
+  for (int i=0; i<lg->m; i++) lg->maxb = max(lg->maxb, gapdata->b[i]);
+
+  lg->u = (double *) malloc_e(lg->n * sizeof(double));
+  lg->g = (int *) malloc_e(lg->n * sizeof(int));
+  lg->f = (double *) malloc_e((lg->maxb + 1) * sizeof(double));
+  lg->item = (int *) malloc_e(lg->n * sizeof(int));
+  lg->keep = (char *) malloc_e((size_t) lg->n * (lg->maxb + 1));
+
+  /* u_j = min_i c_{ij} gives the trivial bound sum_j min_i c_{ij} */
+  for (int j=0; j<lg->n; j++) {
+    c = INT_MAX;
+    for (int i=0; i<lg->m; i++) c = min(c, gapdata->c[i][j]);
+    lg->u[j] = c;
+  }
+  lg->lambda = 2.0;
+  lg->since = 0;
+  lg->value = -1e300;
+  lg->bound = INT_MIN;
+  lg->iter = 0;
+  lg->exact = false;
+  lg->spent = 0;
+  lg->next = 0;
+}
+
+void lagrange_free(Lagrange *lg) {
+  free((void *) lg->u);
+  free((void *) lg->g);
+  free((void *) lg->f);
+  free((void *) lg->item);
+  free((void *) lg->keep);
+}
+
+/***** the knapsack of agent i under u; g_j -= x_{ij}; returns its value *****/
+static double lagrange_knapsack(Lagrange *lg, int i, GAPdata *gapdata) {
+  int b = gapdata->b[i];
+  int items = 0, a, w;
+  char *keep;
+
+  for (int j=0; j<lg->n; j++) {
+    if (gapdata->c[i][j] < lg->u[j] && gapdata->a[i][j] <= b) lg->item[items++] = j;
+  }
+  if (b < 0) return 0.0;
+  for (w=0; w<=b; w++) lg->f[w] = 0.0;
+
+  for (int k=0; k<items; k++) {
+    int j = lg->item[k];
+    double p = lg->u[j] - gapdata->c[i][j];
+
+    a = gapdata->a[i][j];
+    keep = lg->keep + (size_t) k * (lg->maxb + 1);
+    for (w=b; w>=a; w--) {
+      keep[w] = (lg->f[w-a] + p > lg->f[w]);
+      if (keep[w]) lg->f[w] = lg->f[w-a] + p;
+    }
+    for (; w>=0; w--) keep[w] = 0;
+  }
+
+  w = b;
+  for (int k=items-1; k>=0; k--) {
+    if (lg->keep[(size_t) k * (lg->maxb + 1) + w]) {
+      lg->g[lg->item[k]]--;
+      w -= gapdata->a[i][lg->item[k]];
+    }
+  }
+  return -lg->f[b];
+}
+
+/***** run iters subgradient steps; ub is an upper bound or INT_MAX **********/
+int lagrange_bound(Lagrange *lg, GAPdata *gapdata, int iters, int ub) {
+  double value, target, norm, step;
+
+  for (int k=0; k<iters && !lg->exact && lg->bound < ub; k++) {
+    value = 0.0;
+    for (int j=0; j<lg->n; j++) {
+      value += lg->u[j];
+      lg->g[j] = 1;
+    }
+    for (int i=0; i<lg->m; i++) value += lagrange_knapsack(lg, i, gapdata);
+    lg->iter++;
+
+    if (value > lg->value + LAGRANGE_EPS) {
+      lg->value = value;
+      lg->bound = max(lg->bound, (int) ceil(value - LAGRANGE_EPS));
+      lg->since = 0;
+    } else if (++lg->since >= LAGRANGE_PATIENCE) {
+      lg->lambda /= 2;
+      lg->since = 0;
+    }
+
+    norm = 0.0;
+    for (int j=0; j<lg->n; j++) norm += lg->g[j] * lg->g[j];
+    if (norm == 0.0) {
+      lg->exact = true;
+      break;
+    }
+    if (lg->lambda < LAGRANGE_EPS) break;
+
+    target = (ub < INT_MAX) ? ub : lg->value + fabs(lg->value) * 0.05 + 1.0;
+    step = lg->lambda * (target - value) / norm;
+    for (int j=0; j<lg->n; j++) lg->u[j] += step * lg->g[j];
+  }
+
+  return lg->bound;
+}
+
+/***** iterations until iters, the bound reaches ub or the time is up ********/
+/***** the time is the rest of LAGRANGE_SHARE of the limit, read every step **/
+static int lagrange_timed(Lagrange *lg, GAPdata *gapdata, int iters, int ub,
+    const Deadline *dl) {
+  double start = deadline_used(dl), now = start;
+  double until = min(dl->limit, start + LAGRANGE_SHARE * dl->limit - lg->spent);
+
+  for (int k=0; k<iters && now < until && !lg->exact && lg->bound < ub &&
+      lg->lambda >= LAGRANGE_EPS; k++) {
+    lagrange_bound(lg, gapdata, 1, ub);
+    now = deadline_used(dl);
+  }
+  lg->spent += now - start;
+  lg->next = now + LAGRANGE_EVERY * dl->limit;
+  return lg->bound;
+}
+
+/***** the first bound: at most iters iterations in the time of the bound ****/
+int lagrange_start(Lagrange *lg, GAPdata *gapdata, int iters, const Deadline *dl) {
+  return lagrange_timed(lg, gapdata, iters, INT_MAX, dl);
+}
+
+/***** a few iterations towards ub, the cost of a new best, when it is due ***/
+int lagrange_update(Lagrange *lg, GAPdata *gapdata, int ub, const Deadline *dl) {
+  if (dl->over || deadline_elapsed(dl) < lg->next) return lg->bound;
+  return lagrange_timed(lg, gapdata, LAGRANGE_STEPS, ub, dl);
+}
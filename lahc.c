@@ -0,0 +1,80 @@
+/******************************************************************************
+  Late acceptance hill climbing.
+
+  Every step draws a move with anneal_draw() and makes it if its change d
+  of the penalized value satisfies
+
+    d <= 0   or   value + d <= history[iter % length],
+
+  the value "length" steps ago; that slot then takes the current value.
+  The history compares penalized values over time, so the weights must not
+  change during a run; lahc_start() fills the history with the value of
+  the Evaldata to run from.
+
+  With "report" set, every new best prints its line with deadline_best();
+  with "pause" set, lahc_run() also returns at every new best, so that the
+  caller can react to it (e.g., tighten a bound) and then continue the run.
+
+  Include this file after anneal.c.
+******************************************************************************/
+
+typedef struct {
+  int		length;		/* the length of the history */
+  int		*history;	/* history[iter % length]: the value length steps ago */
+  int		value;		/* the current penalized value */
+  long		iter;		/* steps so far */
+  long		accepted;	/* moves made */
+  bool		report;		/* print every new best with deadline_best() */
+  bool		pause;		/* return from lahc_run() at every new best */
+} Lahc;
+
+void lahc_init(Lahc *lh, int length) {
+  lh->length = length;
+  lh->history = (int *) malloc_e(length * sizeof(int));
+  lh->value = 0;
+  lh->iter = lh->accepted = 0;
+  lh->report = lh->pause = false;
+}
+
+void lahc_free(Lahc *lh) {
+  free((void *) lh->history);
+}
+
+/***** start a run from ev: every slot of the history takes its value ********/
+void lahc_start(Lahc *lh, const Evaldata *ev) {
+  lh->value = eval_value(ev);
+  for (int k=0; k<lh->length; k++) lh->history[k] = lh->value;
+}
+
+/***** climb from ev until dl is over or best_cost <= bound ******************/
+/***** best and best_cost are the best feasible solution; returns best_cost **/
+int lahc_run(Lahc *lh, Evaldata *ev, Rng *rng, Deadline *dl,
+    int *best, int best_cost, int bound) {
+  const Jobdata *jd = ev->jd;
+  int d, j1, j2, i, *late;
+
+  while (!deadline_over(dl) && best_cost > bound) {
+    late = &lh->history[lh->iter++ % lh->length];
+    d = anneal_draw(ev, rng, &j1, &j2, &i);
+    if (anneal_noop(ev, j1, j2, i) || (d > 0 && lh->value + d > *late)) {
+      *late = lh->value;
+      continue;
+    }
+    if (j2 < 0) {
+      eval_move(ev, j1, i);
+    } else {
+      eval_swap(ev, j1, j2);
+    }
+    lh->value += d;
+    lh->accepted++;
+    *late = lh->value;
+
+    if (ev->excess == 0 && ev->cost < best_cost) {
+      best_cost = ev->cost;
+      for (int j=0; j<jd->n; j++) best[j] = ev->sol[j];
+      if (lh->report) deadline_best(dl, best_cost);
+      if (lh->pause) break;
+    }
+  }
+  return best_cost;
+}
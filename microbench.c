@@ -0,0 +1,187 @@
+/******************************************************************************
+  Microbenchmarks of the kernels of a solver.
+
+  A solver compiled with -DMICROBENCH calls microbench() right after reading
+  the instance instead of searching. Every kernel is first run for
+  MICROBENCH_WARMUP seconds, which also brings the solution into the state
+  the search keeps it in (e.g., a local optimum for neighbour()), and then
+  timed in MICROBENCH_TRIALS trials of about MICROBENCH_TRIAL seconds each.
+  shift() only moves jobs off overloaded agents, which a solution near a
+  local optimum has none of, so it gets a solution of its own: every call
+  first restores the overloaded initial solution, as the search calls
+  shift() while it has no feasible solution yet. "overload" times the
+  restore alone, so the time of shift() is the difference. Its throughput
+  counts the jobs it visits, which shift() adds up in microbench_visits.
+  The median and the fastest trial are printed per call, together with the
+  throughput in jobs, agents or moves per second and, on x86, the TSC
+  cycles per call.
+
+  Include this file after the prototypes of neighbour(), shift(),
+  calculate_cost() and is_feasible(), and after joblist.c, eval.c,
+  penalty.c and rng.c.
+******************************************************************************/
+
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MICROBENCH_CYCLES() ((double) __rdtsc())
+#else
+#define MICROBENCH_CYCLES() 0.0
+#endif
+
+#define MICROBENCH_WARMUP	0.1	/* seconds of warmup per kernel */
+#define MICROBENCH_TRIAL	0.05	/* seconds per trial */
+#define MICROBENCH_TRIALS	9	/* trials per kernel */
+#define MICROBENCH_VISITS	100	/* calls of shift() to count its visits */
+
+long microbench_visits = 0;	/* the jobs shift() has visited */
+
+typedef void (*Initsol)(int *sol, Rng *rng, const Jobdata *jd, GAPdata *gapdata);
+
+typedef struct {
+  GAPdata	*gapdata;
+  const Jobdata	*jd;
+  Evaldata	ev;		/* the solution neighbour() works on */
+  Evaldata	over;		/* the solution shift() works on */
+  Joblist	*jl;		/* the jobs of over */
+  int		*weight;	/* the penalty weights of ev and over */
+  Rng		rng;
+  Initsol	init;		/* the construction of initial solutions */
+  int		*work;		/* the solution init() writes */
+  int		*start;		/* the initial solution, before the warmup */
+  volatile int	sink;		/* keeps the results of the kernels alive */
+} Microbench;
+
+typedef void (*Kernel)(Microbench *mb);
+
+static double microbench_clock(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int microbench_cmp(const void *x, const void *y) {
+  double d = *(const double *) x - *(const double *) y;
+  return (d > 0) - (d < 0);
+}
+
+/***** time kernel; every call handles "items" units *************************/
+void microbench_run(Microbench *mb, const char *name, Kernel kernel,
+    long items, const char *unit) {
+  double ns[MICROBENCH_TRIALS], cycles[MICROBENCH_TRIALS];
+  double t, c, start = microbench_clock();
+  long calls = 0, batch = 1;
+
+  /* warm up and find the number of calls in one trial */
+  do {
+    for (long k=0; k<batch; k++) kernel(mb);
+    calls += batch;
+    batch *= 2;
+  } while ((t = microbench_clock() - start) < MICROBENCH_WARMUP);
+  calls = (long) (calls * MICROBENCH_TRIAL / t) + 1;
+
+  for (int r=0; r<MICROBENCH_TRIALS; r++) {
+    t = microbench_clock();
+    c = MICROBENCH_CYCLES();
+    for (long k=0; k<calls; k++) kernel(mb);
+    cycles[r] = (MICROBENCH_CYCLES() - c) / calls;
+    ns[r] = (microbench_clock() - t) * 1e9 / calls;
+  }
+  qsort(ns, MICROBENCH_TRIALS, sizeof(double), microbench_cmp);
+  qsort(cycles, MICROBENCH_TRIALS, sizeof(double), microbench_cmp);
+
+  t = ns[MICROBENCH_TRIALS / 2];
+  printf("%-16s %10.1f ns/op (min %10.1f) %12.3e %s/s", name, t, ns[0],
+      items * 1e9 / t, unit);
+  if (cycles[0] > 0) printf(" %10.1f cycles/op", cycles[MICROBENCH_TRIALS / 2]);
+  printf("\n");
+}
+
+static void microbench_neighbour(Microbench *mb) {
+  mb->sink += neighbour(&mb->ev, &mb->rng, mb->gapdata, 1);
+}
+
+/***** restore the overloaded initial solution for shift() *******************/
+static void microbench_overload(Microbench *mb) {
+  for (int j=0; j<mb->gapdata->n; j++) mb->over.sol[j] = mb->start[j];
+  eval_init(&mb->over, mb->over.sol, mb->over.rest_b, mb->weight, mb->jd, mb->gapdata);
+  eval_jobs(&mb->over, mb->jl);
+  mb->sink += mb->over.excess;
+}
+
+static void microbench_shift(Microbench *mb) {
+  microbench_overload(mb);
+  mb->sink += shift(&mb->over, &mb->rng, mb->gapdata);
+}
+
+static void microbench_calculate_cost(Microbench *mb) {
+  mb->sink += calculate_cost(mb->ev.sol, mb->gapdata);
+}
+
+static void microbench_is_feasible(Microbench *mb) {
+  mb->sink += is_feasible(mb->ev.rest_b, mb->gapdata);
+}
+
+static void microbench_init(Microbench *mb) {
+  mb->init(mb->work, &mb->rng, mb->jd, mb->gapdata);
+  mb->sink += mb->work[0];
+}
+
+/***** time the kernels on gapdata; init_name is the name of init ************/
+void microbench(GAPdata *gapdata, int seed, Initsol init, const char *init_name) {
+  int *sol = (int *) malloc_e(gapdata->n * sizeof(int));
+  int *rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  int *over_sol = (int *) malloc_e(gapdata->n * sizeof(int));
+  int *over_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  long visits;
+  int excess;
+  Microbench mb;
+  Penalty pen;
+  Jobdata jd;
+  Joblist jl;
+
+  jobdata_build(&jd, gapdata);
+  joblist_init(&jl, gapdata->m, gapdata->n);
+  penalty_init(&pen, gapdata->m, INFEASIBLE_COST, INFEASIBLE_COST, INFEASIBLE_COST);
+  mb.gapdata = gapdata;
+  mb.jd = &jd;
+  mb.init = init;
+  mb.work = (int *) malloc_e(gapdata->n * sizeof(int));
+  mb.start = (int *) malloc_e(gapdata->n * sizeof(int));
+  mb.weight = pen.weight;
+  mb.jl = &jl;
+  mb.sink = 0;
+  rng_seed(&mb.rng, seed, 0);
+  init(sol, &mb.rng, &jd, gapdata);
+  for (int j=0; j<gapdata->n; j++) mb.start[j] = sol[j];
+  eval_init(&mb.ev, sol, rest_b, pen.weight, &jd, gapdata);
+  mb.over.sol = over_sol;
+  mb.over.rest_b = over_b;
+  microbench_overload(&mb);
+  excess = mb.over.excess;
+
+  /* the jobs shift() visits per call on the initial solution */
+  microbench_visits = 0;
+  for (int r=0; r<MICROBENCH_VISITS; r++) microbench_shift(&mb);
+  visits = max(1, microbench_visits / MICROBENCH_VISITS);
+
+  printf("instance: m = %d, n = %d, %d-byte Jobdata\n", gapdata->m, gapdata->n, jd.width);
+  microbench_run(&mb, init_name, microbench_init, gapdata->n, "jobs");
+  microbench_run(&mb, "neighbour", microbench_neighbour, 1, "moves");
+  printf("shift: %ld of %d jobs visited, excess %d of the initial solution\n",
+      visits, gapdata->n, excess);
+  microbench_run(&mb, "overload", microbench_overload, gapdata->n, "jobs");
+  microbench_run(&mb, "shift", microbench_shift, visits, "visits");
+  microbench_run(&mb, "calculate_cost", microbench_calculate_cost, gapdata->n, "jobs");
+  microbench_run(&mb, "is_feasible", microbench_is_feasible, gapdata->m, "agents");
+
+  jobdata_free(&jd);
+  joblist_free(&jl);
+  penalty_free(&pen);
+  free((void *) mb.work);
+  free((void *) mb.start);
+  free((void *) over_sol);
+  free((void *) over_b);
+  free((void *) sol);
+  free((void *) rest_b);
+}
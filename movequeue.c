@@ -0,0 +1,197 @@
+/******************************************************************************
+  Best-improvement shifts from a priority queue of cached moves.
+
+  A best-improvement descent over the shifts of all jobs looks at O(nm)
+  moves per step, although one shift changes rest_b at two agents only.
+  A Movequeue caches, for every job j, its best shift target among its
+  candidate agents (jd->by_ratio) and the change of the penalized value,
+  and keeps the improving ones in a binary heap ordered by that change.
+
+  The change of shifting job j from agent s to agent t depends only on
+  rest_b[s], rest_b[t] and the weights of s and t. So after a shift from
+  i1 to i2, only the jobs at i1 or i2 (from the Joblist of the Evaldata)
+  and the jobs with i1 or i2 in their candidate list (from the static
+  index "watch") are recomputed. An entry of the heap is not removed when
+  its job is recomputed; it carries the stamp of its job and is dropped
+  when popped with an old stamp (lazy invalidation). When the heap holds
+  more than MOVEQUEUE_SLACK entries per job, the stale ones are purged.
+
+  The stamps and the epoch are unsigned, so that they wrap instead of
+  overflowing, and both restart at every movequeue_descent(), whose heap
+  is empty at the start. The epoch, compared for equality only, also
+  clears seen[] when it wraps within a descent.
+
+  The weights must not change during movequeue_descent(), which rebuilds
+  the cache every time it is called.
+
+  Include this file after joblist.c and eval.c.
+******************************************************************************/
+
+#define MOVEQUEUE_SLACK		4	/* heap entries per job before a purge */
+
+typedef struct {
+  int	value;		/* the change of the penalized value */
+  int	job;		/* the job to shift */
+  unsigned	stamp;	/* the stamp of the job when the entry was made */
+} Moveentry;
+
+typedef struct {
+  int		m;		/* number of agents */
+  int		n;		/* number of jobs */
+  Moveentry	*heap;		/* the improving shifts, the best first */
+  int		size;		/* entries in heap */
+  int		*target;	/* target[j]: the best target agent of job j */
+  unsigned	*stamp;		/* stamp[j]: bumped whenever job j is recomputed */
+  unsigned	*seen;		/* seen[j] == epoch: job j is recomputed already */
+  unsigned	epoch;		/* the current shift */
+  int		*watch;		/* watch[start[i] .. start[i+1]-1]: the jobs */
+  int		*start;		/*   with agent i in their candidate list */
+} Movequeue;
+
+void movequeue_init(Movequeue *mq, const Jobdata *jd) {
+  int i;
+
+  mq->m = jd->m;
+  mq->n = jd->n;
+  mq->heap = (Moveentry *) malloc_e((MOVEQUEUE_SLACK + 1) * jd->n * sizeof(Moveentry));
+  mq->size = 0;
+  mq->target = (int *) malloc_e(jd->n * sizeof(int));
+  mq->stamp = (unsigned *) malloc_e(jd->n * sizeof(unsigned));
+  mq->seen = (unsigned *) malloc_e(jd->n * sizeof(unsigned));
+  mq->epoch = 0;
+  mq->watch = (int *) malloc_e(jd->n * jd->k * sizeof(int));
+  mq->start = (int *) malloc_e((jd->m + 1) * sizeof(int));
+
+  for (int j=0; j<jd->n; j++) mq->stamp[j] = mq->seen[j] = 0;
+  for (i=0; i<=jd->m; i++) mq->start[i] = 0;
+  for (int r=0; r<jd->n * jd->k; r++) mq->start[jd->by_ratio[r] + 1]++;
+  for (i=0; i<jd->m; i++) mq->start[i+1] += mq->start[i];
+  for (int j=0; j<jd->n; j++) {
+    for (int r=0; r<jd->k; r++) {
+      i = jd->by_ratio[j * jd->k + r];
+      mq->watch[mq->start[i]++] = j;
+    }
+  }
+  for (i=jd->m; i>0; i--) mq->start[i] = mq->start[i-1];
+  mq->start[0] = 0;
+}
+
+void movequeue_free(Movequeue *mq) {
+  free((void *) mq->heap);
+  free((void *) mq->target);
+  free((void *) mq->stamp);
+  free((void *) mq->seen);
+  free((void *) mq->watch);
+  free((void *) mq->start);
+}
+
+static inline bool movequeue_less(const Moveentry *x, const Moveentry *y) {
+  return x->value < y->value || (x->value == y->value && x->job < y->job);
+}
+
+static void movequeue_down(Movequeue *mq, int k) {
+  Moveentry e = mq->heap[k];
+  int c;
+
+  while ((c = 2 * k + 1) < mq->size) {
+    if (c + 1 < mq->size && movequeue_less(&mq->heap[c+1], &mq->heap[c])) c++;
+    if (!movequeue_less(&mq->heap[c], &e)) break;
+    mq->heap[k] = mq->heap[c];
+    k = c;
+  }
+  mq->heap[k] = e;
+}
+
+static void movequeue_push(Movequeue *mq, Moveentry e) {
+  int k = mq->size++;
+
+  while (k > 0 && movequeue_less(&e, &mq->heap[(k-1) / 2])) {
+    mq->heap[k] = mq->heap[(k-1) / 2];
+    k = (k-1) / 2;
+  }
+  mq->heap[k] = e;
+}
+
+/***** drop the stale entries and restore the heap in O(size) ****************/
+static void movequeue_purge(Movequeue *mq) {
+  int size = 0;
+
+  for (int k=0; k<mq->size; k++) {
+    if (mq->heap[k].stamp == mq->stamp[mq->heap[k].job]) mq->heap[size++] = mq->heap[k];
+  }
+  mq->size = size;
+  for (int k=size/2-1; k>=0; k--) movequeue_down(mq, k);
+}
+
+/***** find the best target of job j; queue it if it improves ****************/
+static void movequeue_eval(Movequeue *mq, const Evaldata *ev, int j) {
+  const Jobdata *jd = ev->jd;
+  const int *cand = jd->by_ratio + j * jd->k;
+  Moveentry e = {0, j, ++mq->stamp[j]};
+  int v;
+
+  mq->target[j] = -1;
+  for (int r=0; r<jd->k; r++) {
+    if (cand[r] == ev->sol[j]) continue;
+    v = eval_move_delta(ev, j, cand[r]).value;
+    if (v < e.value) {
+      e.value = v;
+      mq->target[j] = cand[r];
+    }
+  }
+  if (mq->target[j] < 0) return;
+  if (mq->size == (MOVEQUEUE_SLACK + 1) * mq->n) movequeue_purge(mq);
+  movequeue_push(mq, e);
+}
+
+/***** recompute the jobs whose shifts changed with agent i ******************/
+static void movequeue_touch(Movequeue *mq, const Evaldata *ev, int i) {
+  const Joblist *jl = ev->jobs;
+  int j;
+
+  for (int k=0; k<jl->count[i]; k++) {
+    j = joblist_job(jl, i, k);
+    if (mq->seen[j] != mq->epoch) {
+      mq->seen[j] = mq->epoch;
+      movequeue_eval(mq, ev, j);
+    }
+  }
+  for (int k=mq->start[i]; k<mq->start[i+1]; k++) {
+    j = mq->watch[k];
+    if (mq->seen[j] != mq->epoch) {
+      mq->seen[j] = mq->epoch;
+      movequeue_eval(mq, ev, j);
+    }
+  }
+}
+
+/***** make the best improving shift until there is none; the shifts made ****/
+int movequeue_descent(Movequeue *mq, Evaldata *ev) {
+  Moveentry e;
+  int moves = 0, from, to;
+
+  mq->size = 0;
+  mq->epoch = 0;
+  for (int j=0; j<mq->n; j++) mq->stamp[j] = mq->seen[j] = 0;
+  for (int j=0; j<mq->n; j++) movequeue_eval(mq, ev, j);
+
+  while (mq->size > 0) {
+    e = mq->heap[0];
+    mq->heap[0] = mq->heap[--mq->size];
+    movequeue_down(mq, 0);
+    if (e.stamp != mq->stamp[e.job]) continue;
+
+    from = ev->sol[e.job];
+    to = mq->target[e.job];
+    eval_move(ev, e.job, to);
+    moves++;
+
+    if (++mq->epoch == 0) {
+      for (int j=0; j<mq->n; j++) mq->seen[j] = 0;
+      mq->epoch = 1;
+    }
+    movequeue_touch(mq, ev, from);
+    movequeue_touch(mq, ev, to);
+  }
+  return moves;
+}
@@ -0,0 +1,81 @@
+/******************************************************************************
+  Multi-start search on a pool of threads.
+
+  multistart_run() starts "threads" workers that repeatedly take the next
+  restart number, seed their own Rng with stream "count" of the seed (as
+  the sequential loops do with rng_seed(&rng, seed, count)), run one
+  restart, and offer the result to a shared Incumbent. The workers share
+  "timelim" CPU seconds: every one stops when its own thread has used
+  timelim / threads of them, so that the process uses about timelim CPU
+  seconds like a sequential solver, whatever the number of threads.
+
+  A restart function builds a solution in sol from scratch, using rest_b as
+  its residual capacities, and returns its cost if it is feasible and
+  INT_MAX otherwise. GAPdata is only read, so all workers share it.
+
+  Include this file after rng.c, deadline.c and incumbent.c; link with
+  -pthread.
+******************************************************************************/
+
+#include <pthread.h>
+
+typedef int (*Restart)(int *sol, int *rest_b, Rng *rng, GAPdata *gapdata);
+
+typedef struct {
+  GAPdata	*gapdata;	/* the instance, shared read-only */
+  Restart	restart;	/* one restart of the local search */
+  Incumbent	*inc;		/* the best solution of all workers */
+  int		seed;		/* the seed of the random number generators */
+  double	timelim;	/* CPU seconds of each worker */
+  _Atomic long	count;		/* restarts taken so far */
+} Multistart;
+
+static void *multistart_worker(void *arg) {
+  Multistart *ms = (Multistart *) arg;
+  int *sol = (int *) malloc_e(ms->gapdata->n * sizeof(int));
+  int *rest_b = (int *) malloc_e(ms->gapdata->m * sizeof(int));
+  Deadline dl;
+  Rng rng;
+  long count;
+  int cost;
+
+  deadline_init_thread(&dl, ms->timelim);
+  while (!deadline_over(&dl)) {
+    count = atomic_fetch_add(&ms->count, 1) + 1;
+    rng_seed(&rng, ms->seed, count);
+    cost = ms->restart(sol, rest_b, &rng, ms->gapdata);
+    if (cost < INT_MAX) incumbent_offer(ms->inc, sol, cost);
+  }
+
+  free((void *) sol);
+  free((void *) rest_b);
+  return NULL;
+}
+
+/***** run restarts on threads workers; returns the number of restarts *******/
+long multistart_run(int threads, Restart restart, int seed, double timelim,
+    Incumbent *inc, GAPdata *gapdata) {
+  pthread_t *tid = (pthread_t *) malloc_e(threads * sizeof(pthread_t));
+  Multistart ms;
+  int started;
+
+  ms.gapdata = gapdata;
+  ms.restart = restart;
+  ms.inc = inc;
+  ms.seed = seed;
+  ms.timelim = timelim / threads;
+  atomic_init(&ms.count, 0);
+
+  for (started=0; started<threads; started++) {
+    if (pthread_create(&tid[started], NULL, multistart_worker, &ms) != 0) break;
+  }
+  if (started == 0) {
+    /* no thread could be created: work in the calling thread */
+    ms.timelim = timelim;
+    multistart_worker(&ms);
+  }
+  for (int k=0; k<started; k++) pthread_join(tid[k], NULL);
+
+  free((void *) tid);
+  return atomic_load(&ms.count);
+}
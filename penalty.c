@@ -0,0 +1,53 @@
+/******************************************************************************
+  Adaptive penalty weights per agent (strategic oscillation).
+
+  A fixed INFEASIBLE_COST either keeps the search in infeasible regions
+  (too small) or makes it avoid the boundary of the feasible region where
+  the good solutions are (too large). penalty_update() is called at the end
+  of every local search instead, and
+
+    - raises the weight of every agent that is still overloaded by 1/4,
+    - lowers every weight by 1/4 if no agent is overloaded,
+
+  always within [lo, hi]. The weights are kept from one restart to the next,
+  so agents that are hard to satisfy get a high weight, and the search is
+  pushed back towards infeasible regions once it keeps finding feasible
+  local optima. Within a local search the weights do not change, so every
+  descent still ends. Weights are changed through eval_weight(), so the
+  penalty of the Evaldata stays consistent with every delta computed from
+  ev->weight.
+
+  Include this file after eval.c.
+******************************************************************************/
+
+typedef struct {
+  int	*weight;	/* the weight of each agent; pass it to eval_init() */
+  int	lo;		/* the smallest weight */
+  int	hi;		/* the largest weight */
+} Penalty;
+
+/***** every weight starts at w, and stays within [lo, hi] *******************/
+void penalty_init(Penalty *pen, int m, int w, int lo, int hi) {
+  pen->weight = (int *) malloc_e(m * sizeof(int));
+  for (int i=0; i<m; i++) pen->weight[i] = w;
+  pen->lo = lo;
+  pen->hi = hi;
+}
+
+void penalty_free(Penalty *pen) {
+  free((void *) pen->weight);
+}
+
+/***** adapt the weights to the local optimum of ev **************************/
+void penalty_update(Penalty *pen, Evaldata *ev, int m) {
+  int w;
+
+  for (int i=0; i<m; i++) {
+    w = ev->weight[i];
+    if (ev->rest_b[i] < 0) {
+      eval_weight(ev, i, min(pen->hi, w + max(1, w / 4)));
+    } else if (ev->excess == 0) {
+      eval_weight(ev, i, max(pen->lo, w - max(1, w / 4)));
+    }
+  }
+}
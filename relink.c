@@ -0,0 +1,83 @@
+/******************************************************************************
+  Path relinking between two solutions.
+
+  Two good solutions usually share most of their assignments, and the
+  solutions between them are often better than a random restart. The walk
+  starts at the solution of an Evaldata and ends at a guiding solution
+  "target": at every step, of the jobs still assigned differently, the one
+  whose shift to its agent in target changes the penalized value the least
+  is shifted there with eval_move(), which updates rest_b, the cost and the
+  penalty in O(1). A walk over d differing jobs evaluates O(d^2) shifts.
+
+  The best point strictly between the two ends is kept: the shifts after it
+  are undone in reverse order, so that the Evaldata is left there for a
+  local search. The two ends themselves are local optima already.
+
+  Include this file after eval.c.
+******************************************************************************/
+
+typedef struct {
+  int	n;		/* number of jobs */
+  int	*diff;		/* the jobs still assigned differently from target */
+  int	*job;		/* job[s]: the job shifted at step s */
+  int	*from;		/* from[s]: the agent it was shifted from */
+  long	walks;		/* walks so far */
+  long	steps;		/* steps of all walks */
+} Relink;
+
+void relink_init(Relink *rl, int n) {
+  rl->n = n;
+  rl->diff = (int *) malloc_e(n * sizeof(int));
+  rl->job = (int *) malloc_e(n * sizeof(int));
+  rl->from = (int *) malloc_e(n * sizeof(int));
+  rl->walks = rl->steps = 0;
+}
+
+void relink_free(Relink *rl) {
+  free((void *) rl->diff);
+  free((void *) rl->job);
+  free((void *) rl->from);
+}
+
+/***** walk ev towards target and stop at the best point between them ********/
+/***** its penalized value; INT_MAX if the two differ in less than 2 jobs ****/
+int relink_run(Relink *rl, Evaldata *ev, const int *target) {
+  int count = 0, step = 0, best_step = 0, best_value = INT_MAX;
+  int j, k, d, pick, delta;
+
+  for (j=0; j<rl->n; j++) {
+    if (ev->sol[j] != target[j]) rl->diff[count++] = j;
+  }
+  if (count < 2) return INT_MAX;
+  rl->walks++;
+
+  /* the last differing job would reach target itself */
+  while (count > 1) {
+    pick = 0;
+    delta = INT_MAX;
+    for (k=0; k<count; k++) {
+      j = rl->diff[k];
+      d = eval_move_delta(ev, j, target[j]).value;
+      if (d < delta) {
+        delta = d;
+        pick = k;
+      }
+    }
+    j = rl->diff[pick];
+    rl->diff[pick] = rl->diff[--count];
+    rl->job[step] = j;
+    rl->from[step++] = ev->sol[j];
+    eval_move(ev, j, target[j]);
+    if (eval_value(ev) < best_value) {
+      best_value = eval_value(ev);
+      best_step = step;
+    }
+  }
+  rl->steps += step;
+
+  while (step > best_step) {
+    step--;
+    eval_move(ev, rl->job[step], rl->from[step]);
+  }
+  return best_value;
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+  A small, fast pseudo random number generator for the search.
+
+  Every search context owns an Rng (xoshiro256**, seeded by splitmix64), so
+  there is no hidden global state as with rand(), and the same seed and
+  stream always give the same sequence on every platform.
+
+  rng_int(rng, n) draws uniformly from [0, n) without the bias of
+  "rand() % n" and without a division in the common case (Lemire's
+  multiply-and-reject method). rng_fill() draws many such values at once,
+  using both 32-bit halves of every 64-bit output.
+******************************************************************************/
+
+#include <stdint.h>
+
+typedef struct {
+  uint64_t	s[4];	/* the state of xoshiro256** */
+} Rng;
+
+static inline uint64_t rng_rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_splitmix(uint64_t *x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/***** seed stream "stream" of seed "seed" ***********************************/
+void rng_seed(Rng *rng, uint64_t seed, uint64_t stream) {
+  uint64_t x = seed ^ rng_splitmix(&stream);
+
+  for (int k=0; k<4; k++) rng->s[k] = rng_splitmix(&x);
+}
+
+/***** the next 64 random bits ***********************************************/
+static inline uint64_t rng_next(Rng *rng) {
+  uint64_t *s = rng->s;
+  uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rng_rotl(s[3], 45);
+  return result;
+}
+
+/***** map 32 random bits x to [0, n); redraw if the result would be biased **/
+static inline int rng_bound(Rng *rng, uint32_t x, uint32_t n) {
+  uint64_t m = (uint64_t) x * n;
+
+  if ((uint32_t) m < n) {
+    uint32_t t = -n % n;
+    while ((uint32_t) m < t) {
+      m = (uint64_t) (uint32_t) (rng_next(rng) >> 32) * n;
+    }
+  }
+  return (int) (m >> 32);
+}
+
+/***** a uniform integer in [0, n), n > 0 ************************************/
+static inline int rng_int(Rng *rng, int n) {
+  return rng_bound(rng, (uint32_t) (rng_next(rng) >> 32), (uint32_t) n);
+}
+
+/***** a uniform double in [0, 1) ********************************************/
+static inline double rng_double(Rng *rng) {
+  return (rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+/***** count uniform integers in [0, n) **************************************/
+void rng_fill(Rng *rng, int *out, int count, int n) {
+  int k = 0;
+  uint64_t x;
+
+  for (; k+1<count; k+=2) {
+    x = rng_next(rng);
+    out[k] = rng_bound(rng, (uint32_t) (x >> 32), (uint32_t) n);
+    out[k+1] = rng_bound(rng, (uint32_t) x, (uint32_t) n);
+  }
+  if (k < count) out[k] = rng_int(rng, n);
+}
@@ -0,0 +1,63 @@
+/******************************************************************************
+  A bounded lock-free ring of solutions from one thread to one other.
+
+  The ring holds up to "capacity" solutions of n jobs with their costs in
+  one array. Only the producer writes "tail" and only the consumer writes
+  "head", each in a cache line of its own. The producer copies a solution
+  into the free slot at tail and then publishes it with a release store of
+  tail + 1; the consumer sees it with an acquire load of tail, copies it
+  out, and frees the slot with a release store of head + 1. Neither side
+  ever waits: spsc_push() drops the solution if the ring is full, and
+  spsc_pop() returns false if it is empty.
+
+  Include this file after the prototype of malloc_e().
+******************************************************************************/
+
+#include <stdatomic.h>
+
+typedef struct {
+  _Alignas(64) _Atomic unsigned	head;	/* the next slot to read; consumer */
+  _Alignas(64) _Atomic unsigned	tail;	/* the next slot to write; producer */
+  _Alignas(64) int		n;	/* number of jobs per solution */
+  unsigned	capacity;	/* solutions in the ring */
+  int		*cost;		/* cost[k]: the cost of slot k */
+  int		*sol;		/* sol[k*n + j]: the solution in slot k */
+} Spsc;
+
+void spsc_init(Spsc *q, unsigned capacity, int n) {
+  atomic_init(&q->head, 0);
+  atomic_init(&q->tail, 0);
+  q->n = n;
+  q->capacity = capacity;
+  q->cost = (int *) malloc_e(capacity * sizeof(int));
+  q->sol = (int *) malloc_e((size_t) capacity * n * sizeof(int));
+}
+
+void spsc_free(Spsc *q) {
+  free((void *) q->cost);
+  free((void *) q->sol);
+}
+
+/***** copy sol into the ring; false if it is full (producer only) ***********/
+bool spsc_push(Spsc *q, const int *sol, int cost) {
+  unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+  unsigned k = tail % q->capacity;
+
+  if (tail - atomic_load_explicit(&q->head, memory_order_acquire) == q->capacity) return false;
+  q->cost[k] = cost;
+  memcpy(q->sol + (size_t) k * q->n, sol, q->n * sizeof(int));
+  atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+  return true;
+}
+
+/***** copy the oldest solution into sol; false if empty (consumer only) *****/
+bool spsc_pop(Spsc *q, int *sol, int *cost) {
+  unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+  unsigned k = head % q->capacity;
+
+  if (head == atomic_load_explicit(&q->tail, memory_order_acquire)) return false;
+  *cost = q->cost[k];
+  memcpy(sol, q->sol + (size_t) k * q->n, q->n * sizeof(int));
+  atomic_store_explicit(&q->head, head + 1, memory_order_release);
+  return true;
+}
@@ -0,0 +1,213 @@
+/******************************************************************************
+  Parallel tempering (replica exchange) on a pool of threads.
+
+  Every thread runs one Metropolis chain (the moves of anneal.c) at a fixed
+  temperature of the geometric ladder
+
+    T_0 = t0 TEMPERING_TOP > T_1 > ... > T_{K-1} = t0 ANNEAL_END,
+
+  where t0 is calibrated as in anneal_calibrate() on a random solution,
+  whose moves are much worse than those around a good one. Hot chains roam,
+  cold chains descend. After every round of TEMPERING_ROUND moves per job the
+  threads meet at a barrier, and one of them proposes to exchange the
+  temperatures of the replicas at neighbouring rungs t and t+1 (the even
+  pairs in even rounds, the odd pairs in odd rounds), accepting with
+  probability
+
+    min(1, exp((1/T_t - 1/T_{t+1}) (E_t - E_{t+1})))
+
+  where E is the penalized value. Exchanging temperatures is the same as
+  exchanging states, without copying any solution. Each replica reports its
+  value and its rung in an exchange slot of its own cache line, so that no
+  two threads write to the same line while the chains run. A replica offers
+  every new feasible best of its own to the shared Incumbent.
+
+  The weights of the penalty are fixed, so that the values of all replicas
+  are comparable. The replicas share "timelim" CPU seconds: all threads
+  stop after the round in which one of them has used timelim / replicas of
+  them, so that the process uses about timelim CPU seconds.
+
+  Include this file after anneal.c and incumbent.c; link with -pthread.
+******************************************************************************/
+
+#include <pthread.h>
+
+#define TEMPERING_ROUND		100	/* moves per job between two exchanges */
+#define TEMPERING_TOP		0.1	/* the hottest temperature / t0 */
+
+typedef struct {
+  _Alignas(64) int	value;	/* the penalized value after the round */
+  int		rung;		/* the index of its temperature in the ladder */
+  bool		over;		/* its time limit has been reached */
+  long		moves;		/* moves tried by this replica */
+} Exchangeslot;
+
+typedef struct {
+  GAPdata	*gapdata;	/* the instance, shared read-only */
+  const Jobdata	*jd;
+  Incumbent	*inc;		/* the best solution of all replicas */
+  int		replicas;	/* the number of replicas K */
+  int		weight;		/* the penalty per unit of excess */
+  int		seed;		/* the seed of the random number generators */
+  double	timelim;	/* CPU seconds of each replica */
+  double	*temp;		/* temp[t]: the temperature of rung t */
+  int		*who;		/* who[t]: the replica at rung t */
+  Exchangeslot	*slot;		/* slot[r]: the exchange slot of replica r */
+  Rng		rng;		/* decides the exchanges */
+  long		rounds;		/* rounds so far */
+  long		tried;		/* exchanges proposed */
+  long		swapped;	/* exchanges accepted */
+  bool		stop;		/* all replicas stop after this round */
+  pthread_barrier_t	barrier;
+  _Atomic int	next;		/* the next replica number to take */
+} Tempering;
+
+/***** propose the exchanges of one round; run by one thread *****************/
+static void tempering_exchange(Tempering *pt) {
+  int r1, r2;
+  double p;
+
+  pt->stop = false;
+  for (int r=0; r<pt->replicas; r++) pt->stop = pt->stop || pt->slot[r].over;
+
+  for (int t=pt->rounds%2; t+1<pt->replicas; t+=2) {
+    r1 = pt->who[t];
+    r2 = pt->who[t+1];
+    p = (1.0 / pt->temp[t] - 1.0 / pt->temp[t+1])
+      * (pt->slot[r1].value - pt->slot[r2].value);
+    pt->tried++;
+    if (p >= 0 || rng_double(&pt->rng) < exp(p)) {
+      pt->who[t] = r2;
+      pt->who[t+1] = r1;
+      pt->slot[r1].rung = t+1;
+      pt->slot[r2].rung = t;
+      pt->swapped++;
+    }
+  }
+  pt->rounds++;
+}
+
+static void *tempering_worker(void *arg) {
+  Tempering *pt = (Tempering *) arg;
+  int r = atomic_fetch_add(&pt->next, 1);
+  Exchangeslot *slot = &pt->slot[r];
+  int n = pt->gapdata->n, m = pt->gapdata->m;
+  int *sol = (int *) malloc_e(n * sizeof(int));
+  int *rest_b = (int *) malloc_e(m * sizeof(int));
+  int *weight = (int *) malloc_e(m * sizeof(int));
+  int best_cost = INT_MAX, d, j1, j2, i;
+  long moves = 0;
+  double t;
+  Evaldata ev;
+  Deadline dl;
+  Rng rng;
+
+  for (int k=0; k<m; k++) weight[k] = pt->weight;
+  rng_seed(&rng, pt->seed, r + 1);
+  rng_fill(&rng, sol, n, m);
+  eval_init(&ev, sol, rest_b, weight, pt->jd, pt->gapdata);
+  deadline_init_thread(&dl, pt->timelim);
+
+  while (!pt->stop) {
+    t = pt->temp[slot->rung];
+    for (long k=0; k<(long) TEMPERING_ROUND * n && !deadline_over(&dl); k++) {
+      d = anneal_draw(&ev, &rng, &j1, &j2, &i);
+      moves++;
+      if (d > 0 && rng_double(&rng) >= exp(-d / t)) continue;
+      if (j2 < 0) {
+        eval_move(&ev, j1, i);
+      } else {
+        eval_swap(&ev, j1, j2);
+      }
+      if (ev.excess == 0 && ev.cost < best_cost) {
+        best_cost = ev.cost;
+        incumbent_offer(pt->inc, sol, best_cost);
+      }
+    }
+    slot->value = eval_value(&ev);
+    slot->over = deadline_over(&dl);
+    slot->moves = moves;
+
+    if (pthread_barrier_wait(&pt->barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+      tempering_exchange(pt);
+    }
+    pthread_barrier_wait(&pt->barrier);
+  }
+
+  free((void *) sol);
+  free((void *) rest_b);
+  free((void *) weight);
+  return NULL;
+}
+
+/***** run replicas chains on as many threads; returns the moves of all ******/
+long tempering_run(int replicas, int seed, double timelim, int weight,
+    Incumbent *inc, const Jobdata *jd, GAPdata *gapdata) {
+  pthread_t *tid = (pthread_t *) malloc_e(replicas * sizeof(pthread_t));
+  int *sol = (int *) malloc_e(gapdata->n * sizeof(int));
+  int *rest_b = (int *) malloc_e(gapdata->m * sizeof(int));
+  int *w = (int *) malloc_e(gapdata->m * sizeof(int));
+  long moves = 0;
+  Tempering pt;
+  Anneal an;
+  Evaldata ev;
+  int started;
+
+  pt.gapdata = gapdata;
+  pt.jd = jd;
+  pt.inc = inc;
+  pt.replicas = replicas;
+  pt.weight = weight;
+  pt.seed = seed;
+  pt.timelim = timelim / replicas;
+  pt.temp = (double *) malloc_e(replicas * sizeof(double));
+  pt.who = (int *) malloc_e(replicas * sizeof(int));
+  pt.slot = (Exchangeslot *) aligned_alloc(64, replicas * sizeof(Exchangeslot));
+  if (pt.slot == NULL) {
+    fprintf(stderr, "aligned_alloc : Not enough memory.\n");
+    exit(EXIT_FAILURE);
+  }
+  pt.rounds = pt.tried = pt.swapped = 0;
+  pt.stop = false;
+  atomic_init(&pt.next, 0);
+
+  /* the ladder from t0 TEMPERING_TOP down to t0 ANNEAL_END */
+  for (int k=0; k<gapdata->m; k++) w[k] = weight;
+  rng_seed(&pt.rng, seed, 0);
+  rng_fill(&pt.rng, sol, gapdata->n, gapdata->m);
+  eval_init(&ev, sol, rest_b, w, jd, gapdata);
+  anneal_init(&an, ANNEAL_GEOMETRIC);
+  anneal_calibrate(&an, &ev, &pt.rng);
+  for (int t=0; t<replicas; t++) {
+    pt.temp[t] = (replicas > 1) ? an.t0 * TEMPERING_TOP
+      * pow(ANNEAL_END / TEMPERING_TOP, (double) t / (replicas - 1)) : an.t1;
+    pt.who[t] = t;
+    pt.slot[t].rung = t;
+    pt.slot[t].over = false;
+    pt.slot[t].moves = 0;
+  }
+
+  pthread_barrier_init(&pt.barrier, NULL, replicas);
+  for (started=0; started<replicas; started++) {
+    if (pthread_create(&tid[started], NULL, tempering_worker, &pt) != 0) break;
+  }
+  if (started < replicas) {
+    fprintf(stderr, "pthread_create : only %d of %d replicas.\n", started, replicas);
+    exit(EXIT_FAILURE);
+  }
+  for (int k=0; k<started; k++) pthread_join(tid[k], NULL);
+  pthread_barrier_destroy(&pt.barrier);
+
+  for (int r=0; r<replicas; r++) moves += pt.slot[r].moves;
+  printf("replicas = %d, T = %.2f .. %.4f, %ld rounds, %ld of %ld exchanges accepted\n",
+      replicas, pt.temp[0], pt.temp[replicas-1], pt.rounds, pt.swapped, pt.tried);
+
+  free((void *) tid);
+  free((void *) sol);
+  free((void *) rest_b);
+  free((void *) w);
+  free((void *) pt.temp);
+  free((void *) pt.who);
+  free((void *) pt.slot);
+  return moves;
+}
@@ -0,0 +1,31 @@
+import argparse
+import os
+import unittest
+
+import bench
+
+# "make test" passes the solver of $(TARGET); ./gap by default.
+SOLVER = os.environ.get('SOLVER', './gap')
+
+
+class TimeToBestTest(unittest.TestCase):
+
+    def test_parse(self):
+        out = ('BEST Cost: 2000 Time: 0.010000\n'
+               'DONE Step: 1 Cost: 1990 Time: 0.020000\n'
+               'BEST Cost: 1950 Time: 0.300000\n'
+               'BEST Cost: 1950 Time: 0.400000\n')
+        self.assertEqual(bench.time_to_best(out), 0.3)
+        self.assertIsNone(bench.time_to_best('DONE Step: 1 Cost: 1990 Time: 0.02\n'))
+
+    @unittest.skipUnless(os.access(SOLVER, os.X_OK), SOLVER + ' is not built')
+    def test_solver(self):
+        args = argparse.Namespace(timelim=1, param=[], data='data')
+        result = bench.run(SOLVER, 'c05100', 1, args)
+        self.assertTrue(result['feasible'])
+        self.assertIsNotNone(result['time_to_best'])
+        self.assertLessEqual(result['time_to_best'], result['time'] + 0.01)
+
+
+if __name__ == '__main__':
+    unittest.main()